@@ -0,0 +1,77 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#include "bricks.h"
+
+#include <algorithm>
+#include <cmath>
+
+void MinMaxBricks::build(const void *data, VolumeType type, const Grid &grid) {
+    switch (type) {
+    case VOLUME_FLOAT16: build((const half *) data, grid); break;
+    case VOLUME_UINT8:   build((const uint8_t *) data, grid); break;
+    case VOLUME_UINT16:  build((const uint16_t *) data, grid); break;
+    case VOLUME_INT16:   build((const int16_t *) data, grid); break;
+    default:             build((const float *) data, grid); break;
+    }
+}
+
+template <typename T>
+void MinMaxBricks::build(const T *data, const Grid &grid) {
+    const int *dims = grid.dims;
+    for (int axis = 0; axis < 3; axis++)
+        n_bricks[axis] = grid.valid() ? (dims[axis] - 2) / SIZE + 1 : 0;
+    _min.assign(count(), INFINITY);
+    _max.assign(count(), -INFINITY);
+
+    // range of each row of samples of the brick first, then of the rows that share the same bricks
+    std::vector<float> row_min(n_bricks[2]), row_max(n_bricks[2]);
+    for (int i = 0; i < dims[0] && count() > 0; i++) {
+        for (int j = 0; j < dims[1]; j++) {
+            const T *row = data + grid.index(i, j, 0);
+            for (int bk = 0; bk < n_bricks[2]; bk++) {
+                int k_end = std::min(dims[2], (bk + 1) * SIZE + 1);
+                float lo = INFINITY, hi = -INFINITY;
+                for (int k = bk * SIZE; k < k_end; k++) {
+                    lo = std::min(lo, toFloat(row[k]));
+                    hi = std::max(hi, toFloat(row[k]));
+                }
+                row_min[bk] = lo;
+                row_max[bk] = hi;
+            }
+
+            // samples on a brick boundary belong to the bricks at both sides
+            for (int bi = std::max(0, (i - 1) / SIZE); bi <= std::min(n_bricks[0] - 1, i / SIZE); bi++) {
+                for (int bj = std::max(0, (j - 1) / SIZE); bj <= std::min(n_bricks[1] - 1, j / SIZE); bj++) {
+                    for (int bk = 0; bk < n_bricks[2]; bk++) {
+                        int b = index(bi, bj, bk);
+                        _min[b] = std::min(_min[b], row_min[bk]);
+                        _max[b] = std::max(_max[b], row_max[bk]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void MinMaxBricks::clear() {
+    n_bricks[0] = n_bricks[1] = n_bricks[2] = 0;
+    _min.clear();
+    _max.clear();
+}
@@ -0,0 +1,57 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#ifndef __MeshViewer_bricks_h_
+#define __MeshViewer_bricks_h_
+#include <vector>
+#include "grid.h"
+#include "scalar.h"
+
+// Range of values of the blocks ("bricks") of SIZE^3 cells of a volume. A brick holds the
+// cells (i, j, k) with i / SIZE, j / SIZE, k / SIZE equal to its coordinates, so its range covers
+// the samples up to the next brick included. Cells of bricks whose range does not contain the
+// isovalue can not be crossed by the surface, and are skipped by the extraction.
+class MinMaxBricks {
+ public:
+  static const int SIZE = 8;
+
+  MinMaxBricks() : n_bricks{0, 0, 0} {}
+  void build(const void *data, VolumeType type, const Grid &grid);
+  void clear();
+
+  // number of bricks along an axis, and in total
+  int size(int axis) const {return n_bricks[axis];}
+  int count() const {return n_bricks[0]*n_bricks[1]*n_bricks[2];}
+  int index(int bi, int bj, int bk) const {return (bi*n_bricks[1] + bj)*n_bricks[2] + bk;}
+  float min(int b) const {return _min[b];}
+  float max(int b) const {return _max[b];}
+  // whether the cells of the brick may be crossed by the isosurface
+  bool active(int b, float isovalue) const {return _min[b] <= isovalue && _max[b] > isovalue;}
+  // bytes used by the ranges
+  size_t memory() const {return (_min.capacity() + _max.capacity()) * sizeof(float);}
+
+ private:
+  int n_bricks[3];
+  std::vector<float> _min, _max;
+
+  template <typename T>
+  void build(const T *data, const Grid &grid);
+};
+
+#endif // __MeshViewer_bricks_h_
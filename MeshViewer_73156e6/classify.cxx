@@ -0,0 +1,195 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#include "classify.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MC_X86_KERNELS 1
+#endif
+
+// classifies the cells k0..n-1, appending the active ones after the first n_active
+template <typename T>
+static inline int classifyCells(const T *r00, const T *r01, const T *r10, const T *r11,
+                                int k0, int n, float isovalue, unsigned char *cases, int *active, int n_active) {
+    for (int k = k0; k < n; k++) {
+        int c = (toFloat(r00[k]) > isovalue)      | (toFloat(r00[k + 1]) > isovalue) << 1 |
+                (toFloat(r01[k]) > isovalue) << 2 | (toFloat(r01[k + 1]) > isovalue) << 3 |
+                (toFloat(r10[k]) > isovalue) << 4 | (toFloat(r10[k + 1]) > isovalue) << 5 |
+                (toFloat(r11[k]) > isovalue) << 6 | (toFloat(r11[k + 1]) > isovalue) << 7;
+        cases[k] = c;
+        active[n_active] = k;
+        n_active += c != 0 && c != 255;
+    }
+    return n_active;
+}
+
+template <typename T>
+int classifyRowScalar(const T *r00, const T *r01, const T *r10, const T *r11,
+                      int n, float isovalue, unsigned char *cases, int *active) {
+    return classifyCells(r00, r01, r10, r11, 0, n, isovalue, cases, active, 0);
+}
+
+#ifdef MC_X86_KERNELS
+
+// 8 and 16 consecutive samples converted to float
+__attribute__((target("avx2,f16c"))) static inline __m256 load8(const float *p) {
+    return _mm256_loadu_ps(p);
+}
+__attribute__((target("avx2,f16c"))) static inline __m256 load8(const half *p) {
+    return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *) p));
+}
+__attribute__((target("avx2,f16c"))) static inline __m256 load8(const uint8_t *p) {
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) p)));
+}
+__attribute__((target("avx2,f16c"))) static inline __m256 load8(const uint16_t *p) {
+    return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) p)));
+}
+__attribute__((target("avx2,f16c"))) static inline __m256 load8(const int16_t *p) {
+    return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) p)));
+}
+
+// (the maskz forms avoid spurious uninitialized warnings of GCC about the plain conversions)
+__attribute__((target("avx512f"))) static inline __m512 load16(const float *p) {
+    return _mm512_loadu_ps(p);
+}
+__attribute__((target("avx512f"))) static inline __m512 load16(const half *p) {
+    return _mm512_maskz_cvtph_ps(0xffff, _mm256_loadu_si256((const __m256i *) p));
+}
+__attribute__((target("avx512f"))) static inline __m512 load16(const uint8_t *p) {
+    return _mm512_maskz_cvtepi32_ps(0xffff, _mm512_maskz_cvtepu8_epi32(0xffff, _mm_loadu_si128((const __m128i *) p)));
+}
+__attribute__((target("avx512f"))) static inline __m512 load16(const uint16_t *p) {
+    return _mm512_maskz_cvtepi32_ps(0xffff, _mm512_maskz_cvtepu16_epi32(0xffff, _mm256_loadu_si256((const __m256i *) p)));
+}
+__attribute__((target("avx512f"))) static inline __m512 load16(const int16_t *p) {
+    return _mm512_maskz_cvtepi32_ps(0xffff, _mm512_maskz_cvtepi16_epi32(0xffff, _mm256_loadu_si256((const __m256i *) p)));
+}
+
+// 8 cells per iteration: each corner is compared against the isovalue in a 32 bit lane, and the
+// comparison masks are merged into the case index with the corner bit.
+template <typename T>
+__attribute__((target("avx2,f16c")))
+static int classifyRowAVX2(const T *r00, const T *r01, const T *r10, const T *r11,
+                           int n, float isovalue, unsigned char *cases, int *active) {
+    const __m256 iso = _mm256_set1_ps(isovalue);
+    const T *rows[4] = {r00, r01, r10, r11};
+    // gathers the low byte of each 32 bit lane in the low 8 bytes of the register
+    const __m256i pack_bytes = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i pack_lanes = _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1);
+    const __m256i all_above = _mm256_set1_epi32(255);
+
+    int n_active = 0;
+    int k = 0;
+    for (; k + 8 <= n; k += 8) {
+        __m256i c = _mm256_setzero_si256();
+        for (int r = 0; r < 4; r++) {
+            __m256 above_0 = _mm256_cmp_ps(load8(rows[r] + k), iso, _CMP_GT_OQ);
+            __m256 above_1 = _mm256_cmp_ps(load8(rows[r] + k + 1), iso, _CMP_GT_OQ);
+            c = _mm256_or_si256(c, _mm256_and_si256(_mm256_castps_si256(above_0), _mm256_set1_epi32(1 << (2*r))));
+            c = _mm256_or_si256(c, _mm256_and_si256(_mm256_castps_si256(above_1), _mm256_set1_epi32(2 << (2*r))));
+        }
+        __m256i bytes = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(c, pack_bytes), pack_lanes);
+        _mm_storel_epi64((__m128i *)(cases + k), _mm256_castsi256_si128(bytes));
+
+        __m256i inactive = _mm256_or_si256(_mm256_cmpeq_epi32(c, _mm256_setzero_si256()),
+                                           _mm256_cmpeq_epi32(c, all_above));
+        unsigned int mask = ~_mm256_movemask_ps(_mm256_castsi256_ps(inactive)) & 0xff;
+        while (mask) {
+            active[n_active++] = k + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+    return classifyCells(r00, r01, r10, r11, k, n, isovalue, cases, active, n_active);
+}
+
+// 16 cells per iteration, using the comparison mask registers directly.
+template <typename T>
+__attribute__((target("avx512f")))
+static int classifyRowAVX512(const T *r00, const T *r01, const T *r10, const T *r11,
+                             int n, float isovalue, unsigned char *cases, int *active) {
+    const __m512 iso = _mm512_set1_ps(isovalue);
+    const T *rows[4] = {r00, r01, r10, r11};
+
+    int n_active = 0;
+    int k = 0;
+    for (; k + 16 <= n; k += 16) {
+        __m512i c = _mm512_setzero_si512();
+        for (int r = 0; r < 4; r++) {
+            __mmask16 above_0 = _mm512_cmp_ps_mask(load16(rows[r] + k), iso, _CMP_GT_OQ);
+            __mmask16 above_1 = _mm512_cmp_ps_mask(load16(rows[r] + k + 1), iso, _CMP_GT_OQ);
+            c = _mm512_mask_or_epi32(c, above_0, c, _mm512_set1_epi32(1 << (2*r)));
+            c = _mm512_mask_or_epi32(c, above_1, c, _mm512_set1_epi32(2 << (2*r)));
+        }
+        _mm512_mask_cvtepi32_storeu_epi8(cases + k, 0xffff, c);
+
+        unsigned int mask = _mm512_cmpneq_epi32_mask(c, _mm512_setzero_si512()) &
+                            _mm512_cmpneq_epi32_mask(c, _mm512_set1_epi32(255));
+        while (mask) {
+            active[n_active++] = k + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+    return classifyCells(r00, r01, r10, r11, k, n, isovalue, cases, active, n_active);
+}
+
+#endif // MC_X86_KERNELS
+
+enum KernelLevel {KERNEL_SCALAR, KERNEL_AVX2, KERNEL_AVX512};
+
+static KernelLevel selectKernel() {
+#ifdef MC_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return KERNEL_AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c"))
+        return KERNEL_AVX2;
+#endif
+    return KERNEL_SCALAR;
+}
+
+static const KernelLevel kernel = selectKernel();
+
+template <typename T>
+int classifyRow(const T *r00, const T *r01, const T *r10, const T *r11,
+                int n, float isovalue, unsigned char *cases, int *active) {
+    switch (kernel) {
+#ifdef MC_X86_KERNELS
+    case KERNEL_AVX512: return classifyRowAVX512(r00, r01, r10, r11, n, isovalue, cases, active);
+    case KERNEL_AVX2:   return classifyRowAVX2(r00, r01, r10, r11, n, isovalue, cases, active);
+#endif
+    default:            return classifyRowScalar(r00, r01, r10, r11, n, isovalue, cases, active);
+    }
+}
+
+const char *classifyKernelName() {
+    static const char *names[] = {"scalar", "avx2", "avx512"};
+    return names[kernel];
+}
+
+#define INSTANTIATE_CLASSIFY(T) \
+    template int classifyRow<T>(const T *, const T *, const T *, const T *, int, float, unsigned char *, int *); \
+    template int classifyRowScalar<T>(const T *, const T *, const T *, const T *, int, float, unsigned char *, int *);
+
+INSTANTIATE_CLASSIFY(float)
+INSTANTIATE_CLASSIFY(half)
+INSTANTIATE_CLASSIFY(uint8_t)
+INSTANTIATE_CLASSIFY(uint16_t)
+INSTANTIATE_CLASSIFY(int16_t)
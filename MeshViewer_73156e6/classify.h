@@ -0,0 +1,41 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#ifndef __MeshViewer_classify_h_
+#define __MeshViewer_classify_h_
+#include "scalar.h"
+
+// Marching cubes classification of a row of cells. The cells k = 0..n-1 of the row (i, j) have
+// their corners in the rows j and j+1 of the sample planes i and i+1:
+//   r00 = (i, j), r01 = (i, j+1), r10 = (i+1, j), r11 = (i+1, j+1)
+// each holding n+1 samples of type T (float, half, uint8_t, uint16_t or int16_t). The case
+// index of each cell (see taulaMC.hpp) is written to cases, and the indices of the cells crossed
+// by the surface (case other than 0 and 255) are written in increasing order to active.
+// Returns the number of active cells.
+
+// kernel chosen for this CPU at startup (AVX-512, AVX2 or the scalar fallback)
+template <typename T>
+int classifyRow(const T *r00, const T *r01, const T *r10, const T *r11,
+                int n, float isovalue, unsigned char *cases, int *active);
+template <typename T>
+int classifyRowScalar(const T *r00, const T *r01, const T *r10, const T *r11,
+                      int n, float isovalue, unsigned char *cases, int *active);
+const char *classifyKernelName();
+
+#endif // __MeshViewer_classify_h_
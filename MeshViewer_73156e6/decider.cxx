@@ -0,0 +1,182 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#include "decider.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+// cases with ambiguous faces, one per combination of decisions on them
+const int N_RESOLVED_CASES = 520;
+
+// The triangles are found by tracing the contour of the surface on the faces of the cube. Seen
+// from outside, each face joins every crossed edge where its boundary goes down (counterclockwise,
+// from a corner above the isovalue to one below) to one where it goes up: the next one if the
+// corners above are joined across the face, the previous one otherwise, so that the corners
+// above are on the left of the contour. Every crossed edge is left by the contour on one of its
+// faces and reached on the other, so the contour closes into polygons. A polygon is split with
+// diagonals between edges on different faces only: one between two edges of a face would lie
+// on it, where the cell next to it may place a different triangle. Polygons that can not be
+// split that way (one per case at most) are joined to MC_CELL_CENTER.
+struct ResolvedCases {
+    unsigned char ambiguous_faces[256];
+    unsigned short first[256];
+    MCresolvedCase cases[N_RESOLVED_CASES];
+
+    unsigned char edge_faces[12];
+
+    ResolvedCases() {
+        for (int e = 0; e < 12; e++) {
+            edge_faces[e] = 0;
+            for (int f = 0; f < 6; f++) {
+                const int *c = MC_FACES[f];
+                if (std::count(c, c + 4, MC_EDGES[e][0]) && std::count(c, c + 4, MC_EDGES[e][1]))
+                    edge_faces[e] |= 1 << f;
+            }
+        }
+
+        int n_cases = 0;
+        for (int MC_config = 0; MC_config < 256; MC_config++) {
+            auto above = [&](int corner) {return (MC_config >> corner & 1) != 0;};
+            ambiguous_faces[MC_config] = 0;
+            for (int f = 0; f < 6; f++) {
+                const int *c = MC_FACES[f];
+                if (above(c[0]) == above(c[3]) && above(c[1]) == above(c[2]) && above(c[0]) != above(c[1]))
+                    ambiguous_faces[MC_config] |= 1 << f;
+            }
+            first[MC_config] = n_cases;
+            if (ambiguous_faces[MC_config] == 0)
+                continue;
+
+            int n_ambiguous = __builtin_popcount(ambiguous_faces[MC_config]);
+            for (int joined = 0; joined < 1 << n_ambiguous; joined++) {
+                assert(n_cases < N_RESOLVED_CASES);
+                trace(MC_config, joined, cases[n_cases++]);
+            }
+        }
+        assert(n_cases == N_RESOLVED_CASES);
+    }
+
+    static int edgeBetween(int corner_0, int corner_1) {
+        for (int e = 0; e < 12; e++)
+            if ((MC_EDGES[e][0] == corner_0 && MC_EDGES[e][1] == corner_1) ||
+                (MC_EDGES[e][0] == corner_1 && MC_EDGES[e][1] == corner_0))
+                return e;
+        return -1;
+    }
+
+    // whether the part of a polygon from its vertex a to b can be split into triangles, taking
+    // the line from a to b as a side. split[a][b] is the third vertex of the triangle on it.
+    bool splittable(const int *polygon, int a, int b, int split[12][12]) const {
+        if (b == a + 1)
+            return true;
+        for (int m = a + 1; m < b; m++) {
+            if ((m == a + 1 || !(edge_faces[polygon[a]] & edge_faces[polygon[m]])) &&
+                (m == b - 1 || !(edge_faces[polygon[m]] & edge_faces[polygon[b]])) &&
+                splittable(polygon, a, m, split) && splittable(polygon, m, b, split)) {
+                split[a][b] = m;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void addTriangles(const int *polygon, int a, int b, const int split[12][12], MCresolvedCase &resolved) {
+        if (b == a + 1)
+            return;
+        int m = split[a][b];
+        addTriangle(polygon[a], polygon[m], polygon[b], resolved);
+        addTriangles(polygon, a, m, split, resolved);
+        addTriangles(polygon, m, b, split, resolved);
+    }
+
+    static void addTriangle(int edge_0, int edge_1, int edge_2, MCresolvedCase &resolved) {
+        assert(resolved.n_triangles < MC_RESOLVED_MAX_TRIANGLES);
+        unsigned char *triangle = &resolved.edges[3*resolved.n_triangles++];
+        triangle[0] = edge_0;
+        triangle[1] = edge_1;
+        triangle[2] = edge_2;
+    }
+
+    void trace(int MC_config, int joined, MCresolvedCase &resolved) const {
+        auto above = [&](int corner) {return (MC_config >> corner & 1) != 0;};
+        int next_edge[12];
+        int n_ambiguous = 0;
+        for (int f = 0; f < 6; f++) {
+            // corners counterclockwise seen from outside: (axis + 1, axis + 2) is counterclockwise
+            // seen from the end of the axis
+            const int *c = MC_FACES[f];
+            int ring[4] = {c[0], c[1], c[3], c[2]};
+            if (f % 2 == 0)
+                std::swap(ring[1], ring[3]);
+
+            int crossed[4], down[4], n_crossed = 0;
+            for (int n = 0; n < 4; n++) {
+                int corner_0 = ring[n], corner_1 = ring[(n + 1) % 4];
+                if (above(corner_0) != above(corner_1)) {
+                    crossed[n_crossed] = edgeBetween(corner_0, corner_1);
+                    down[n_crossed++] = above(corner_0);
+                }
+            }
+            bool join = false;
+            if (ambiguous_faces[MC_config] >> f & 1)
+                join = joined >> n_ambiguous++ & 1;
+            for (int n = 0; n < n_crossed; n++)
+                if (down[n])
+                    next_edge[crossed[n]] = crossed[(n + (join ? 1 : n_crossed - 1)) % n_crossed];
+        }
+
+        resolved.n_triangles = 0;
+        resolved.center_edges = 0;
+        int visited = 0;
+        for (int e = 0; e < 12; e++) {
+            if (!(MC_EDGE_MASK[MC_config] >> e & 1) || (visited >> e & 1))
+                continue;
+            int polygon[12], n_vertices = 0;
+            for (int v = e; !(visited >> v & 1); v = next_edge[v]) {
+                visited |= 1 << v;
+                polygon[n_vertices++] = v;
+            }
+            int split[12][12];
+            if (splittable(polygon, 0, n_vertices - 1, split)) {
+                addTriangles(polygon, 0, n_vertices - 1, split, resolved);
+            } else {
+                assert(resolved.center_edges == 0);
+                for (int v = 0; v < n_vertices; v++) {
+                    resolved.center_edges |= 1 << polygon[v];
+                    addTriangle(MC_CELL_CENTER, polygon[v], polygon[(v + 1) % n_vertices], resolved);
+                }
+            }
+        }
+    }
+};
+
+const ResolvedCases resolved_cases;
+
+}
+
+int mcAmbiguousFaces(int MC_config) {
+    return resolved_cases.ambiguous_faces[MC_config];
+}
+
+const MCresolvedCase &mcResolvedCase(int MC_config, int joined) {
+    return resolved_cases.cases[resolved_cases.first[MC_config] + joined];
+}
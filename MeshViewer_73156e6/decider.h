@@ -0,0 +1,60 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#ifndef __MeshViewer_decider_h_
+#define __MeshViewer_decider_h_
+#include "taulaMC.hpp"
+
+// Marching cubes cases whose ambiguous faces are resolved with the asymptotic decider. On a face
+// whose corners above the isovalue are diagonally opposite, the table of MC_CASES always makes
+// the same choice, which may not match the trilinear interpolation of the samples. The decider
+// compares the isovalue with the value of the bilinear interpolation at the saddle point of the
+// face, so the topology of the surface on every face is that of the interpolated field. Both
+// cells of a face take the same decision, so the surface has no cracks.
+
+// faces of the cube, as their corners at offsets (0, 0), (1, 0), (0, 1) and (1, 1) along the
+// axes (axis + 1) % 3 and (axis + 2) % 3. Faces 2*axis and 2*axis + 1 are at offset 0 and 1.
+constexpr int MC_FACES[6][4] = {{0, 2, 1, 3}, {4, 6, 5, 7}, {0, 1, 4, 5}, {2, 3, 6, 7}, {0, 4, 2, 6}, {1, 5, 3, 7}};
+
+// The contour of some cases can only be split into triangles along the faces of the cube, which
+// would overlap those of the neighbour cells, so it is joined to a vertex inside the cell instead:
+// the average of the crossings on the edges of center_edges, given as edge MC_CELL_CENTER.
+#define MC_RESOLVED_MAX_TRIANGLES 12
+#define MC_CELL_CENTER 12
+
+struct MCresolvedCase {
+  unsigned char n_triangles;
+  unsigned short center_edges;
+  unsigned char edges[3*MC_RESOLVED_MAX_TRIANGLES];
+};
+
+// ambiguous faces of a case (bit f set for face f)
+int mcAmbiguousFaces(int MC_config);
+// triangles of a case with ambiguous faces, where bit n of joined is set when the corners above
+// the isovalue are joined across the n-th of them
+const MCresolvedCase &mcResolvedCase(int MC_config, int joined);
+
+// whether the corners above the isovalue of an ambiguous face are joined across it: the value at
+// the saddle point of the face is above the isovalue. Values are given relative to the isovalue,
+// in the order of MC_FACES.
+inline bool mcJoinedAcross(float f00, float f10, float f01, float f11) {
+  return (f00 * f11 - f10 * f01) * (f00 + f11 - f10 - f01) > 0.f;
+}
+
+#endif // __MeshViewer_decider_h_
@@ -0,0 +1,109 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#include "extractionworker.h"
+
+#include <algorithm>
+
+ExtractionWorker::ExtractionWorker(const Scene &cache_owner, int n_workers, std::function<void()> ready) :
+    ready(ready), stop(false), last_id(0) {
+    for (int w = 0; w < std::max(1, n_workers); w++) {
+        workers.emplace_back(new Worker);
+        Worker &worker = *workers.back();
+        worker.scene.shareVolumeCache(cache_owner);
+        worker.scene.setCancelFlag(&worker.cancelled);
+        worker.cancelled = false;
+        worker.thread = std::thread(&ExtractionWorker::run, this, std::ref(worker));
+    }
+}
+
+ExtractionWorker::~ExtractionWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+        for (std::unique_ptr<Worker> &worker : workers)
+            worker->cancelled = true;
+    }
+    wake.notify_all();
+    for (std::unique_ptr<Worker> &worker : workers)
+        worker->thread.join();
+}
+
+unsigned long ExtractionWorker::extract(const Scene::Settings &settings, const std::string &volume, float isovalue,
+                                        bool preview) {
+    std::lock_guard<std::mutex> lock(mutex);
+    requests.push_back(Request{++last_id, settings, volume, isovalue, preview});
+    wake.notify_one();
+    return last_id;
+}
+
+void ExtractionWorker::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    requests.clear();
+    results.clear();
+    for (std::unique_ptr<Worker> &worker : workers)
+        worker->cancelled = true;
+}
+
+bool ExtractionWorker::takeResult(Result &result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (results.empty())
+        return false;
+    result = std::move(results.front());
+    results.pop_front();
+    return true;
+}
+
+void ExtractionWorker::run(Worker &worker) {
+    Scene &scene = worker.scene;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] {return !requests.empty() || stop;});
+        if (stop)
+            return;
+        // cancelling from now on stops this request
+        Request request = requests.front();
+        requests.pop_front();
+        worker.cancelled = false;
+        lock.unlock();
+
+        scene.setSettings(request.settings);
+        scene.clear_meshes();
+        scene.setIsovalue(request.isovalue);
+        scene.computeVolumeIsosurface(request.volume.c_str(), request.preview);
+
+        lock.lock();
+        if (worker.cancelled)
+            continue;
+        Result result;
+        result.request = request.id;
+        result.volume = request.volume;
+        result.loaded = scene.volume_loaded();
+        result.min_value = scene.min_value();
+        result.max_value = scene.max_value();
+        result.isovalue = request.isovalue;
+        result.preview = request.preview;
+        scene.take_meshes(result.meshes, result.surfaces);
+        result.stats = scene.stats();
+        results.push_back(std::move(result));
+        lock.unlock();
+        ready();
+        lock.lock();
+    }
+}
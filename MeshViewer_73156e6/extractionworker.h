@@ -0,0 +1,96 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#ifndef __MeshViewer_extractionworker_h_
+#define __MeshViewer_extractionworker_h_
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "scene.h"
+
+// Extracts isosurfaces on a pool of worker threads, so that the thread requesting them is not
+// blocked. Each worker has a scene of its own, which shares the volume cache of the one given.
+// Requests are extracted in the order they are made, as many at once as there are workers, and
+// cancel drops all of them: the ones waiting, and the ones in progress at the next check of the
+// extraction. Each time an isosurface is ready, the callback is called from its worker thread,
+// and the isosurface can then be taken with takeResult.
+class ExtractionWorker {
+ public:
+  struct Result {
+    unsigned long request;  // as returned by extract
+    std::string volume;
+    bool loaded;            // whether the volume could be read
+    float min_value, max_value;
+    float isovalue;
+    bool preview;
+    // the isosurface (none if it is empty), as the output mode of the settings gives it
+    std::vector<std::pair<MyMesh,Scene::ColorInfo> > meshes;
+    std::vector<IsoSurface> surfaces;
+    ExtractionStats stats;
+  };
+
+  ExtractionWorker(const Scene &cache_owner, int n_workers, std::function<void()> ready);
+  ~ExtractionWorker();
+
+  // queues the extraction of the isosurface of the volume with the settings given, and returns
+  // the id of the request (increasing with each request)
+  unsigned long extract(const Scene::Settings &settings, const std::string &volume, float isovalue,
+                        bool preview = false);
+  // cancels the requests being extracted or waiting, and drops the results not taken yet
+  void cancel();
+  // the oldest isosurface extracted and not taken yet, if any
+  bool takeResult(Result &result);
+
+ private:
+  struct Request {
+    unsigned long id;
+    Scene::Settings settings;
+    std::string volume;
+    float isovalue;
+    bool preview;
+  };
+  struct Worker {
+    Scene scene;
+    std::atomic<bool> cancelled;
+    std::thread thread;
+  };
+
+  std::vector<std::unique_ptr<Worker> > workers;
+  std::function<void()> ready;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<Request> requests;
+  std::deque<Result> results;
+  bool stop;
+  unsigned long last_id;
+
+  void run(Worker &worker);
+
+  ExtractionWorker(const ExtractionWorker &);
+  ExtractionWorker &operator=(const ExtractionWorker &);
+};
+
+#endif // __MeshViewer_extractionworker_h_
@@ -22,18 +22,21 @@
 #include <iostream>
 #define _USE_MATH_DEFINES 1
 #include <cmath>
+#include <cstddef>
 #include "checkgl.h"
 #include <assert.h>
 #include <QApplication>
 #include <QFileDialog>
 #include <QString>
 #include <QAction>
+#include <QActionGroup>
 #include <QCursor>
 #include <QImageWriter>
 #include <QPushButton>
 
 
-glwin::glwin(const std::string &args)
+// two workers, so that the preview of an isovalue is not waiting for the full surface of another
+glwin::glwin(const std::string &args) : workers(scene, 2, [this]() {emit extracted();})
 {
     mainArgs = args;
     mainShaderP = 0;
@@ -48,12 +51,24 @@ glwin::glwin(const std::string &args)
     popup_menu = new QMenu("Menu", this); // Creates the app pop-up menu
     setup_menu();
     save_animation = false;
+    isovalue = -INFINITY;
+    first_request = shown_request = 0;
+    progressive = false;
+    isosurface_shown = false;
+    connect(this, SIGNAL(extracted()), this, SLOT(showExtracted()), Qt::QueuedConnection);
+
+    // isosurfaces are uploaded straight from the interleaved buffers of the extraction
+    scene.setOutputMode(Scene::INTERLEAVED_BUFFERS);
 
     arg_isovalue = -(int)INFINITY;
 
     if (args.size() > 0) {
         std::stringstream ss(args);
         ss >> arg_isovalue;
+
+        int num_threads;
+        if (ss >> num_threads)
+            scene.setNumThreads(num_threads);
     }
 }
 
@@ -63,6 +78,39 @@ void glwin::setup_menu()
     connect(action, SIGNAL(triggered()), this, SLOT(computeVolumeIsosurface()));
     popup_menu->addAction(action);
 
+    action = new QAction("Normals from the volume gradient", this);
+    action->setCheckable(true);
+    connect(action, SIGNAL(toggled(bool)), this, SLOT(setGradientNormals(bool)));
+    popup_menu->addAction(action);
+
+    action = new QAction("Progressive preview while editing", this);
+    action->setCheckable(true);
+    connect(action, SIGNAL(toggled(bool)), this, SLOT(setProgressive(bool)));
+    popup_menu->addAction(action);
+
+    QMenu *methods_menu = popup_menu->addMenu("Extraction method");
+    QActionGroup *methods = new QActionGroup(this);
+    const char *method_names[] = {"Marching cubes", "Surface nets", "Dual contouring",
+                                  "Marching cubes, asymptotic decider", "Adaptive dual contouring"};
+    for (int m = Scene::MARCHING_CUBES; m <= Scene::ADAPTIVE_DUAL_CONTOURING; m++) {
+        action = new QAction(method_names[m], this);
+        action->setCheckable(true);
+        action->setChecked(m == scene.extractionMethod());
+        action->setData(m);
+        methods->addAction(action);
+        methods_menu->addAction(action);
+    }
+    connect(methods, SIGNAL(triggered(QAction*)), this, SLOT(setExtractionMethod(QAction*)));
+
+    action = new QAction("Collect extraction statistics", this);
+    action->setCheckable(true);
+    connect(action, SIGNAL(toggled(bool)), this, SLOT(setCollectStats(bool)));
+    popup_menu->addAction(action);
+
+    action = new QAction("Save extraction statistics", this);
+    connect(action, SIGNAL(triggered()), this, SLOT(saveStats()));
+    popup_menu->addAction(action);
+
     action = new QAction("Load Volume", this);
     connect(action, SIGNAL(triggered()), this, SLOT(loadVolume()));
     popup_menu->addAction(action);
@@ -115,14 +163,14 @@ void glwin::loadMesh(const char *name)
 
 void glwin::loadVolume()
 {
-    QString file = QFileDialog::getOpenFileName(NULL, "Select a volume to add:", "", "Meshes (*.txt);;All Files (*)");
+    QString file = QFileDialog::getOpenFileName(NULL, "Select a volume to add:", "", "Volumes (*.txt *.vol);;All Files (*)");
     loadVolume(file.toStdString().c_str());
 }
 
 void glwin::loadVolume(const char *name)
 {
     int num_new_nodes = scene.loadVolume(name);
-    if (scene.loadVolume(name) > 0)
+    if (num_new_nodes > 0)
     {
         for (int i = scene.meshes().size() - num_new_nodes; i < (int)scene.meshes().size(); i++)
         {
@@ -134,41 +182,157 @@ void glwin::loadVolume(const char *name)
 
 void glwin::computeVolumeIsosurface()
 {
-    QString file = QFileDialog::getOpenFileName(NULL, "Select a volume to add:", "", "Meshes (*.txt);;All Files (*)");
+    QString file = QFileDialog::getOpenFileName(NULL, "Select a volume to add:", "", "Volumes (*.txt *.vol);;All Files (*)");
     computeVolumeIsosurface(file.toStdString().c_str());
-
-    slider->setMinimum(scene.min_value());
-    slider->setMaximum(scene.max_value()-1.f);
-
-    if (arg_isovalue == slider->value())
-        setValue(arg_isovalue);
-    else
-        slider->setValue(arg_isovalue > -(int)INFINITY ? arg_isovalue : slider->minimum());
 }
 
+// the volume is loaded by the workers, and replaces the current one when its first isosurface
+// is shown (unless it can not be read)
 void glwin::computeVolumeIsosurface(const char *name)
 {
-    if (scene.computeVolumeIsosurface(name))
-    {
-        addToRender(scene.meshes().back());
-        update();
-    }
+    pending_volume = name;
+    requestIsosurface();
 }
 
+// the isosurface of the isovalue is extracted by the workers (first its preview in progressive
+// mode), and shown by showExtracted when ready
+void glwin::requestIsosurface()
+{
+    const std::string &volume = pending_volume.empty() ? volume_name : pending_volume;
+    if (volume.empty())
+        return;
+    // isosurfaces still waiting or in progress are of an older isovalue
+    workers.cancel();
+    Scene::Settings settings = scene.settings();
+    first_request = 0;
+    if (progressive)
+        first_request = workers.extract(settings, volume, isovalue, true);
+    unsigned long request = workers.extract(settings, volume, isovalue);
+    if (first_request == 0)
+        first_request = request;
+}
 
-void glwin::setValue(int val)
+// releases the GL buffers of the isosurface shown, and leaves the bounding box of the scene
+// to the other meshes, so that replacing the isosurface does not grow it
+void glwin::removeIsosurface()
 {
-    if (scene.meshes().size() > 0) {
+    if (isosurface_shown) {
+        makeCurrent();
+        glDeleteVertexArrays(1, &VAOS.back());
+        glDeleteBuffers(vertexBuffers.back().size(), vertexBuffers.back().data());
         VAOS.pop_back();
+        vertexBuffers.pop_back();
         elementsSize.pop_back();
         drawMethods.pop_back();
-        scene.clear_meshes();
+        boxes.pop_back();
+        bb = BoundingBox();
+        for (const BoundingBox &box : boxes)
+            bb.add(box);
+        isosurface_shown = false;
+    }
+    scene.clear_meshes();
+}
+
+void glwin::setValue(int val)
+{
+    isovalue = val;
+    if (!save_animation) {
+        requestIsosurface();
+        return;
     }
 
-    scene.setIsovalue((double)val);
-    if (scene.volume_names().size() > 0)
-        computeVolumeIsosurface(scene.volume_names().back().c_str());
+    // each frame of an animation is saved once its isosurface is shown, so it is extracted here
+    workers.cancel();
+    removeIsosurface();
+    scene.setIsovalue(isovalue);
+    bool extracted = !volume_name.empty() && scene.computeVolumeIsosurface(volume_name.c_str());
+    isosurface_stats = scene.stats();
+    if (extracted)
+    {
+        if (scene.outputMode() != Scene::HALFEDGE_MESH)
+            addToRender(scene.surfaces().back());
+        else
+            addToRender(scene.meshes().back());
+        isosurface_shown = true;
+    }
+}
+
+// replaces the isosurface shown by the ones extracted since, unless they are stale: requested
+// before the last isovalue, or a preview of a surface already shown
+void glwin::showExtracted()
+{
+    ExtractionWorker::Result result;
+    while (workers.takeResult(result)) {
+        if (result.request < first_request || result.request <= shown_request)
+            continue;
+        shown_request = result.request;
+        if (!result.loaded) {
+            pending_volume.clear();
+            continue;
+        }
+
+        removeIsosurface();
+        isosurface_stats = result.stats;
+        if (!result.surfaces.empty()) {
+            addToRender(result.surfaces.back());
+            isosurface_shown = true;
+        } else if (!result.meshes.empty()) {
+            addToRender(result.meshes.back());
+            isosurface_shown = true;
+        }
+
+        if (result.volume == pending_volume) {
+            volume_name = pending_volume;
+            pending_volume.clear();
+            slider->setMinimum(result.min_value);
+            slider->setMaximum(result.max_value - 1.f);
+
+            if (arg_isovalue == slider->value())
+                setValue(arg_isovalue);
+            else
+                slider->setValue(arg_isovalue > -(int)INFINITY ? arg_isovalue : slider->minimum());
+        }
+    }
+    update();
+}
+
+void glwin::setGradientNormals(bool enabled)
+{
+    scene.setNormalMode(enabled ? Scene::GRADIENT_NORMALS : Scene::FACE_NORMALS);
+    // recompute the current isosurface with the new normals
+    if (!volume_name.empty())
+        setValue(slider->value());
+}
+
+// in progressive mode the slider extracts isosurfaces while it is dragged: a preview from the
+// downsampled volume first, then the full resolution one
+void glwin::setProgressive(bool enabled)
+{
+    progressive = enabled;
+    slider->setTracking(enabled);
+    if (!enabled && !volume_name.empty())
+        setValue(slider->value());
+}
 
+void glwin::setExtractionMethod(QAction *action)
+{
+    scene.setExtractionMethod(Scene::ExtractionMethod(action->data().toInt()));
+    // recompute the current isosurface with the new method
+    if (!volume_name.empty())
+        setValue(slider->value());
+}
+
+void glwin::setCollectStats(bool enabled)
+{
+    scene.setCollectStats(enabled);
+}
+
+// stages and counters of the last isosurface computed, including its upload
+void glwin::saveStats()
+{
+    QString file = QFileDialog::getSaveFileName(NULL, "Save the extraction statistics as:", "", "JSON (*.json);;All Files (*)");
+    if (!file.isEmpty())
+        isosurface_stats.writeJson(file.toStdString().c_str());
 }
 
 void glwin::animate()
@@ -522,6 +686,7 @@ void glwin::addToRender(const std::pair<MyMesh, Scene::ColorInfo> &mesh_)
 {
     const MyMesh &m = mesh_.first;
     Scene::ColorInfo ci = mesh_.second;
+    StageTimer timer(scene.collectsStats() ? &isosurface_stats : nullptr, ExtractionStats::UPLOAD);
     makeCurrent();
     glUseProgram(mainShaderP);
     GLuint VAO;
@@ -532,6 +697,7 @@ void glwin::addToRender(const std::pair<MyMesh, Scene::ColorInfo> &mesh_)
         drawMethods.push_back(USE_ELEMENTS);
         GLuint VBOS[4];
         glGenBuffers(4, VBOS);
+        vertexBuffers.push_back(std::vector<GLuint>(VBOS, VBOS + 4));
         glBindBuffer(GL_ARRAY_BUFFER, VBOS[0]);
         glBufferData(GL_ARRAY_BUFFER, m.n_vertices() * sizeof(typename MyMesh::Point),
                      m.points(), GL_STATIC_DRAW);
@@ -592,6 +758,7 @@ void glwin::addToRender(const std::pair<MyMesh, Scene::ColorInfo> &mesh_)
         drawMethods.push_back(USE_ARRAYS);
         GLuint VBOS[3];
         glGenBuffers(3, VBOS);
+        vertexBuffers.push_back(std::vector<GLuint>(VBOS, VBOS + 3));
         const unsigned int mida = m.n_faces() * 9;
         std::vector<GLfloat> vertexBuff;
         vertexBuff.reserve(mida);
@@ -647,7 +814,92 @@ void glwin::addToRender(const std::pair<MyMesh, Scene::ColorInfo> &mesh_)
     BoundingBox bbaux(p);
     for (unsigned int i = 1; i < m.n_vertices(); ++i)
         bbaux.add(p + 3 * i);
-    boxes.push_back(std::move(bbaux));
+    fitCamera(bbaux);
+}
+
+//
+// Same as above for an isosurface kept as flat arrays: positions, normals
+// and indices are uploaded as they are, and the (constant) color is given
+// as a generic vertex attribute instead of a buffer. Interleaved vertices
+// are uploaded as a single buffer, colors included.
+void glwin::addToRender(const IsoSurface &surface)
+{
+    StageTimer timer(scene.collectsStats() ? &isosurface_stats : nullptr, ExtractionStats::UPLOAD);
+    makeCurrent();
+    glUseProgram(mainShaderP);
+    GLuint VAO;
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+    drawMethods.push_back(USE_ELEMENTS);
+    // the indices, then the interleaved vertices or the positions and normals
+    const bool interleaved = !surface.vertices.empty();
+    const int n_buffers = interleaved ? 2 : 3;
+    GLuint VBOS[3];
+    glGenBuffers(n_buffers, VBOS);
+    vertexBuffers.push_back(std::vector<GLuint>(VBOS, VBOS + n_buffers));
+
+    BoundingBox bbaux;
+    if (interleaved)
+    {
+        const GLsizei stride = sizeof(InterleavedVertex);
+        glBindBuffer(GL_ARRAY_BUFFER, VBOS[1]);
+        glBufferData(GL_ARRAY_BUFFER, surface.vertices.size() * stride,
+                     surface.vertices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride,
+                              (const GLvoid *)offsetof(InterleavedVertex, position));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride,
+                              (const GLvoid *)offsetof(InterleavedVertex, normal));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 3, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                              (const GLvoid *)offsetof(InterleavedVertex, color));
+        glEnableVertexAttribArray(2);
+
+        for (const InterleavedVertex &v : surface.vertices)
+        {
+            double p[3] = {v.position[0], v.position[1], v.position[2]};
+            bbaux.add(p);
+        }
+    }
+    else
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, VBOS[1]);
+        glBufferData(GL_ARRAY_BUFFER, surface.positions.size() * sizeof(GLfloat),
+                     surface.positions.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+        glEnableVertexAttribArray(0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBOS[2]);
+        glBufferData(GL_ARRAY_BUFFER, surface.normals.size() * sizeof(GLfloat),
+                     surface.normals.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
+        glEnableVertexAttribArray(1);
+
+        glDisableVertexAttribArray(2);
+        glVertexAttrib3f(2, 0.6, 0.6, 0.6);
+
+        for (size_t i = 0; i < surface.positions.size(); i += 3)
+        {
+            double p[3] = {surface.positions[i], surface.positions[i + 1], surface.positions[i + 2]};
+            bbaux.add(p);
+        }
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, VBOS[0]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, surface.indices.size() * sizeof(GLuint),
+                 surface.indices.data(), GL_STATIC_DRAW);
+    elementsSize.push_back(surface.indices.size());
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    VAOS.push_back(VAO);
+    fitCamera(bbaux);
+}
+
+void glwin::fitCamera(const BoundingBox &bbaux)
+{
+    boxes.push_back(bbaux);
     bb.add(bbaux);
     //std::cerr << "Box:   (" << bbaux.min()[0] << ", " << bbaux.min()[1] << ", " << bbaux.min()[2]
     //          << "),  (" << bbaux.max()[0] << ", " << bbaux.max()[1] << ", " << bbaux.max()[2]
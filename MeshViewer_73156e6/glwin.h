@@ -33,6 +33,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "scene.h"
+#include "extractionworker.h"
 #include "utils.h"
 
 
@@ -46,6 +47,10 @@ class glwin : public QOpenGLWidget, public QOpenGLFunctions_3_3_Core
   void loadVolume(const char *name);
   void computeVolumeIsosurface(const char *name);
 
+ signals:
+  // emitted from a worker thread when an isosurface is ready
+  void extracted();
+
  private slots:
   void setValue(int val);
   void animate();
@@ -54,15 +59,35 @@ class glwin : public QOpenGLWidget, public QOpenGLFunctions_3_3_Core
   void loadMesh();
   void addCube();
   void addCubeVC();
+  void setGradientNormals(bool enabled);
+  void setProgressive(bool enabled);
+  void showExtracted();
+  void setExtractionMethod(QAction *action);
+  void setCollectStats(bool enabled);
+  void saveStats();
   
  private:
   Scene scene;
+  // extract the isosurfaces of the volume, sharing the volume cache of scene
+  ExtractionWorker workers;
+  std::string volume_name;      // volume of the isosurfaces, empty if none
+  std::string pending_volume;   // replaces it once loaded, setting the range of the slider
+  float isovalue;
+  unsigned long first_request;  // results of older requests are stale
+  unsigned long shown_request;
+  bool progressive;
+  bool isosurface_shown;        // the last VAO is the isosurface of the volume
+  ExtractionStats isosurface_stats;
   void setup_menu();
+  void requestIsosurface();
+  void removeIsosurface();
   void drawAxes();
   void addRotation(glm::vec3 axis, float angle);
   void updateCameraTransform();
   void updateProjectionTransform();
   void addToRender(const std::pair<MyMesh,Scene::ColorInfo> &mesh_);
+  void addToRender(const IsoSurface &surface);
+  void fitCamera(const BoundingBox &bbaux);
   void SaveImageAs();
 
   virtual void initializeGL() Q_DECL_OVERRIDE;
@@ -81,6 +106,7 @@ class glwin : public QOpenGLWidget, public QOpenGLFunctions_3_3_Core
   GLuint VAOeixos;
   typedef enum {SKIP=0, USE_ARRAYS, USE_ELEMENTS} DrawMethod;
   std::vector<GLuint> VAOS;
+  std::vector<std::vector<GLuint> > vertexBuffers; // buffers of each VAO, deleted with it
   std::vector<GLsizei> elementsSize;
   std::vector<DrawMethod> drawMethods;
   BoundingBox bb;
@@ -0,0 +1,77 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#include "grid.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+bool Grid::readHeader(std::istream &volume_file) {
+    // the first line holds the number of samples along each axis (a single N for N^3 volumes),
+    // optionally followed by the spacing and the origin of the grid
+    std::string header;
+    std::getline(volume_file, header);
+    std::istringstream fields(header);
+    std::vector<std::string> tokens;
+    std::vector<float> values;
+    std::string token;
+    while (fields >> token) {
+        char *end;
+        float value = std::strtof(token.c_str(), &end);
+        if (*end != '\0')
+            break;
+        tokens.push_back(token);
+        values.push_back(value);
+    }
+
+    if (values.size() == 1) {
+        values.resize(3, values[0]);
+        tokens.resize(3, tokens[0]);
+    }
+    bool valid = values.size() == 3 || values.size() == 6 || values.size() == 9;
+
+    // the sample counts must be integers, with at least one cell along each axis
+    long n[3] = {0, 0, 0};
+    for (int axis = 0; valid && axis < 3; axis++) {
+        char *end;
+        errno = 0;
+        n[axis] = std::strtol(tokens[axis].c_str(), &end, 10);
+        valid = *end == '\0' && errno == 0 && n[axis] >= 2 && n[axis] <= INT_MAX;
+    }
+    if (!valid) {
+        std::cerr << "Invalid volume header: " << header << std::endl;
+        return false;
+    }
+
+    // by default the volume is scaled to fit the unit cube
+    for (int axis = 0; axis < 3; axis++)
+        dims[axis] = int(n[axis]);
+    float cell_size = 1.f / std::max({dims[0], dims[1], dims[2], 1});
+    for (int axis = 0; axis < 3; axis++) {
+        spacing[axis] = values.size() > 3 ? values[3 + axis] : cell_size;
+        origin[axis] = values.size() > 6 ? values[6 + axis] : 0.f;
+    }
+    return true;
+}
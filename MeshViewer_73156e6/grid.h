@@ -0,0 +1,43 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#ifndef __MeshViewer_grid_h_
+#define __MeshViewer_grid_h_
+#include <cstddef>
+#include <istream>
+
+// Sampling grid of a volume: number of samples along each axis, distance between consecutive
+// samples and position of the first one. Sample (i, j, k) lies at origin + (i, j, k) * spacing
+// and is stored at index(i, j, k), with i the slowest axis.
+struct Grid {
+  int dims[3];
+  float spacing[3];
+  float origin[3];
+
+  Grid() : dims{0, 0, 0}, spacing{1.f, 1.f, 1.f}, origin{0.f, 0.f, 0.f} {}
+  size_t n_samples() const {return (size_t)dims[0]*dims[1]*dims[2];}
+  size_t index(int i, int j, int k) const {return ((size_t)i*dims[1] + j)*dims[2] + k;}
+  // whether there is at least one cell
+  bool valid() const {return dims[0] > 1 && dims[1] > 1 && dims[2] > 1;}
+
+  // reads the header line of a text volume file
+  bool readHeader(std::istream &volume_file);
+};
+
+#endif // __MeshViewer_grid_h_
@@ -0,0 +1,355 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#include "octree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include "taulaMC.hpp"
+
+void Octree::build(const void *data, VolumeType type, const Grid &grid, const MinMaxBricks &bricks, float isovalue,
+                   float tolerance, int n_threads, const std::atomic<bool> *cancel) {
+    switch (type) {
+    case VOLUME_FLOAT16: build((const half *) data, grid, bricks, isovalue, tolerance, n_threads, cancel); break;
+    case VOLUME_UINT8:   build((const uint8_t *) data, grid, bricks, isovalue, tolerance, n_threads, cancel); break;
+    case VOLUME_UINT16:  build((const uint16_t *) data, grid, bricks, isovalue, tolerance, n_threads, cancel); break;
+    case VOLUME_INT16:   build((const int16_t *) data, grid, bricks, isovalue, tolerance, n_threads, cancel); break;
+    default:             build((const float *) data, grid, bricks, isovalue, tolerance, n_threads, cancel); break;
+    }
+}
+
+// whether the bricks of the cells of the node inside the volume may be crossed by the surface
+static bool crossed(const Octree::Node &node, const Grid &grid, const MinMaxBricks &bricks, float isovalue) {
+    const int S = MinMaxBricks::SIZE;
+    int last[3] = {std::min(node.i + node.size, grid.dims[0] - 1) - 1, std::min(node.j + node.size, grid.dims[1] - 1) - 1,
+                   std::min(node.k + node.size, grid.dims[2] - 1) - 1};
+    for (int bi = node.i / S; bi <= last[0] / S; bi++)
+        for (int bj = node.j / S; bj <= last[1] / S; bj++)
+            for (int bk = node.k / S; bk <= last[2] / S; bk++)
+                if (bricks.active(bricks.index(bi, bj, bk), isovalue))
+                    return true;
+    return false;
+}
+
+static bool outside(const Octree::Node &node, const Grid &grid) {
+    return node.i >= grid.dims[0] - 1 || node.j >= grid.dims[1] - 1 || node.k >= grid.dims[2] - 1;
+}
+
+// whether the corners of the set are connected by the edges of the cube
+static bool connectedCorners(int set) {
+    int reached = set & -set;
+    for (bool grown = true; grown; ) {
+        grown = false;
+        for (int e = 0; e < 12; e++) {
+            int c_0 = MC_EDGES[e][0], c_1 = MC_EDGES[e][1];
+            if ((set >> c_0 & 1) && (set >> c_1 & 1) && ((reached >> c_0 ^ reached >> c_1) & 1)) {
+                reached |= 1 << c_0 | 1 << c_1;
+                grown = true;
+            }
+        }
+    }
+    return reached == set;
+}
+
+template <typename T>
+void Octree::build(const T *data, const Grid &grid, const MinMaxBricks &bricks, float isovalue, float tolerance,
+                   int n_threads, const std::atomic<bool> *cancel) {
+    int root_size = 1;
+    while (root_size < std::max(grid.dims[0], std::max(grid.dims[1], grid.dims[2])) - 1)
+        root_size *= 2;
+
+    // the nodes larger than TASK_SIZE are split first, breadth first, then the subtrees below
+    // them are built by the threads and appended in the same order whatever their number
+    nodes.assign(1, Node{0, 0, 0, root_size, LEAF, 0});
+    std::vector<int> tasks;
+    for (size_t n = 0; n < nodes.size(); n++) {
+        Node node = nodes[n];
+        if (outside(node, grid)) {
+            nodes[n].children = OUTSIDE;
+        } else if (!crossed(node, grid, bricks, isovalue)) {
+            continue;
+        } else if (node.size <= TASK_SIZE) {
+            tasks.push_back(n);
+        } else {
+            int half = node.size / 2;
+            nodes[n].children = nodes.size();
+            for (int c = 0; c < 8; c++)
+                nodes.push_back(Node{node.i + (c >> 2)*half, node.j + (c >> 1 & 1)*half, node.k + (c & 1)*half, half,
+                                     LEAF, 0});
+        }
+    }
+
+    std::vector<std::vector<Node> > subtrees(tasks.size());
+    std::atomic<size_t> next_task(0);
+    auto buildTasks = [&]() {
+        for (size_t t = next_task++; t < tasks.size() && !(cancel && *cancel); t = next_task++) {
+            subtrees[t].assign(1, nodes[tasks[t]]);
+            buildNode(subtrees[t], 0, data, grid, bricks, isovalue, tolerance);
+        }
+    };
+    n_threads = std::min<int>(n_threads, tasks.size());
+    if (n_threads <= 1) {
+        buildTasks();
+    } else {
+        std::vector<std::thread> workers;
+        for (int w = 0; w < n_threads; w++)
+            workers.emplace_back(buildTasks);
+        for (std::thread &w : workers)
+            w.join();
+    }
+
+    // the root of a subtree replaces its task node, the rest are appended
+    for (size_t t = 0; t < tasks.size(); t++) {
+        int base = nodes.size() - 1;
+        for (size_t n = 0; n < subtrees[t].size(); n++) {
+            Node node = subtrees[t][n];
+            if (node.children >= 0)
+                node.children += base;
+            if (n == 0)
+                nodes[tasks[t]] = node;
+            else
+                nodes.push_back(node);
+        }
+        std::vector<Node>().swap(subtrees[t]);
+    }
+}
+
+template <typename T>
+void Octree::buildNode(std::vector<Node> &nodes, int n, const T *data, const Grid &grid, const MinMaxBricks &bricks,
+                       float isovalue, float tolerance) const {
+    // a copy, since adding the children may move the nodes
+    Node node = nodes[n];
+    if (outside(node, grid)) {
+        nodes[n].children = OUTSIDE;
+        return;
+    }
+    if (!crossed(node, grid, bricks, isovalue))
+        return;
+    if (node.size == 1) {
+        for (int c = 0; c < 8; c++)
+            if (toFloat(data[grid.index(node.i + (c >> 2), node.j + (c >> 1 & 1), node.k + (c & 1))]) > isovalue)
+                nodes[n].corners |= 1 << c;
+        return;
+    }
+
+    int half = node.size / 2, children = nodes.size();
+    nodes[n].children = children;
+    for (int c = 0; c < 8; c++)
+        nodes.push_back(Node{node.i + (c >> 2)*half, node.j + (c >> 1 & 1)*half, node.k + (c & 1)*half, half, LEAF, 0});
+    for (int c = 0; c < 8; c++)
+        buildNode(nodes, children + c, data, grid, bricks, isovalue, tolerance);
+
+    // children that are all leaves are the last nodes, and merged if the node can be kept whole
+    if (node.i + node.size >= grid.dims[0] || node.j + node.size >= grid.dims[1] || node.k + node.size >= grid.dims[2])
+        return;
+    for (int c = 0; c < 8; c++)
+        if (nodes[children + c].children != LEAF)
+            return;
+    if (keepWhole(node, data, grid, isovalue, tolerance)) {
+        nodes.resize(children);
+        nodes[n] = node;
+        for (int c = 0; c < 8; c++)
+            if (toFloat(data[grid.index(node.i + (c >> 2)*node.size, node.j + (c >> 1 & 1)*node.size,
+                                        node.k + (c & 1)*node.size)]) > isovalue)
+                nodes[n].corners |= 1 << c;
+    }
+}
+
+template <typename T>
+bool Octree::keepWhole(const Node &node, const T *data, const Grid &grid, float isovalue, float tolerance) const {
+    const int s = node.size;
+    float corner[8];
+    int config = 0;
+    for (int c = 0; c < 8; c++) {
+        corner[c] = toFloat(data[grid.index(node.i + (c >> 2)*s, node.j + (c >> 1 & 1)*s, node.k + (c & 1)*s)]) - isovalue;
+        config |= (corner[c] > 0.f) << c;
+    }
+    // a single sheet, so that one vertex can stand for the surface in the node
+    bool surface = config != 0 && config != 255;
+    if (surface && !(connectedCorners(config) && connectedCorners(~config & 255)))
+        return false;
+
+    // trilinear interpolation of the corners at each sample, and its gradient per voxel. The
+    // surface moves by about the difference with the sample over the gradient, which is only
+    // measured within a voxel of the interpolated surface.
+    for (int a = 0; a <= s; a++) {
+        float x = float(a) / s;
+        float p[4], dp_dx[4];
+        for (int yz = 0; yz < 4; yz++) {
+            p[yz] = corner[yz] + x * (corner[4 | yz] - corner[yz]);
+            dp_dx[yz] = corner[4 | yz] - corner[yz];
+        }
+        for (int b = 0; b <= s; b++) {
+            float y = float(b) / s;
+            float q_0 = p[0] + y * (p[2] - p[0]), q_1 = p[1] + y * (p[3] - p[1]);
+            float dq_dx_0 = dp_dx[0] + y * (dp_dx[2] - dp_dx[0]), dq_dx_1 = dp_dx[1] + y * (dp_dx[3] - dp_dx[1]);
+            const T *row = data + grid.index(node.i + a, node.j + b, node.k);
+            for (int c = 0; c <= s; c++) {
+                float z = float(c) / s;
+                float t = q_0 + z * (q_1 - q_0);
+                float f = toFloat(row[c]) - isovalue;
+                if ((f > 0.f) != (t > 0.f))
+                    return false;
+                if (!surface)
+                    continue;
+
+                float dt_dx = dq_dx_0 + z * (dq_dx_1 - dq_dx_0);
+                float dt_dy = (p[2] - p[0]) + z * ((p[3] - p[1]) - (p[2] - p[0]));
+                float gradient = std::sqrt(dt_dx * dt_dx + dt_dy * dt_dy + (q_1 - q_0) * (q_1 - q_0)) / s;
+                if (std::abs(t) <= gradient && std::abs(f - t) > tolerance * gradient)
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Octree::contour(std::vector<EdgeLeaf> &quads) const {
+    quads.clear();
+    if (!nodes.empty())
+        cellProc(0, quads);
+}
+
+// the bit of child corners along an axis
+static int axisBit(int axis) {
+    return 4 >> axis;
+}
+
+// the edge of the cube between two corners
+static int cubeEdge(int c_0, int c_1) {
+    int e = 0;
+    while (!(MC_EDGES[e][0] == c_0 && MC_EDGES[e][1] == c_1) && !(MC_EDGES[e][0] == c_1 && MC_EDGES[e][1] == c_0))
+        e++;
+    return e;
+}
+
+void Octree::cellProc(int n, std::vector<EdgeLeaf> &quads) const {
+    int children = nodes[n].children;
+    if (children < 0)
+        return;
+    for (int c = 0; c < 8; c++)
+        cellProc(children + c, quads);
+
+    for (int axis = 0; axis < 3; axis++) {
+        int u = (axis + 1) % 3, v = (axis + 2) % 3;
+        // faces between the children, and edges between the four children along each half
+        for (int c = 0; c < 8; c++)
+            if (!(c & axisBit(axis)))
+                faceProc(children + c, children + (c | axisBit(axis)), axis, quads);
+        for (int h = 0; h < 2; h++) {
+            int around[2][2];
+            for (int x = 0; x < 2; x++)
+                for (int y = 0; y < 2; y++)
+                    around[x][y] = children + (h ? axisBit(axis) : 0) + (x ? axisBit(u) : 0) + (y ? axisBit(v) : 0);
+            edgeProc(around, axis, quads);
+        }
+    }
+}
+
+// n_0 and n_1 are on the low and high side of a face across the axis
+void Octree::faceProc(int n_0, int n_1, int axis, std::vector<EdgeLeaf> &quads) const {
+    if (nodes[n_0].children == OUTSIDE || nodes[n_1].children == OUTSIDE ||
+        (nodes[n_0].children == LEAF && nodes[n_1].children == LEAF))
+        return;
+    int u = (axis + 1) % 3, v = (axis + 2) % 3;
+    for (int c = 0; c < 4; c++) {
+        int in_face = (c & 1 ? axisBit(u) : 0) + (c & 2 ? axisBit(v) : 0);
+        faceProc(child(n_0, axisBit(axis) + in_face), child(n_1, in_face), axis, quads);
+    }
+
+    // edges along u and v in the middle of the face
+    for (int edge_axis : {u, v}) {
+        int w = edge_axis == u ? v : u;
+        for (int h = 0; h < 2; h++) {
+            int around[2][2];
+            for (int side = 0; side < 2; side++) {
+                for (int sw = 0; sw < 2; sw++) {
+                    int corner = (side ? 0 : axisBit(axis)) + (h ? axisBit(edge_axis) : 0) + (sw ? axisBit(w) : 0);
+                    int n = child(side ? n_1 : n_0, corner);
+                    if ((edge_axis + 1) % 3 == axis)
+                        around[side][sw] = n;
+                    else
+                        around[sw][side] = n;
+                }
+            }
+            edgeProc(around, edge_axis, quads);
+        }
+    }
+}
+
+// around[x][y] is on the low (0) or high (1) side of the edge along axes axis + 1 and axis + 2
+void Octree::edgeProc(const int around[2][2], int axis, std::vector<EdgeLeaf> &quads) const {
+    bool leaves = true;
+    for (int x = 0; x < 2; x++) {
+        for (int y = 0; y < 2; y++) {
+            if (nodes[around[x][y]].children == OUTSIDE)
+                return;
+            leaves &= nodes[around[x][y]].children == LEAF;
+        }
+    }
+    int u = (axis + 1) % 3, v = (axis + 2) % 3;
+    if (!leaves) {
+        for (int h = 0; h < 2; h++) {
+            int halves[2][2];
+            for (int x = 0; x < 2; x++)
+                for (int y = 0; y < 2; y++)
+                    halves[x][y] = child(around[x][y], (h ? axisBit(axis) : 0) + (x ? 0 : axisBit(u)) +
+                                                       (y ? 0 : axisBit(v)));
+            edgeProc(halves, axis, quads);
+        }
+        return;
+    }
+
+    // the minimal edge is that of the smallest leaf, whose samples are on the boundary of all
+    // of them. A leaf without surface has the same sign at all its samples, so the surface
+    // can not cross it.
+    int smallest_x = 0, smallest_y = 0;
+    for (int x = 0; x < 2; x++) {
+        for (int y = 0; y < 2; y++) {
+            const Node &leaf = nodes[around[x][y]];
+            if (leaf.corners == 0 || leaf.corners == 255)
+                return;
+            if (leaf.size < nodes[around[smallest_x][smallest_y]].size) {
+                smallest_x = x;
+                smallest_y = y;
+            }
+        }
+    }
+    int corners = nodes[around[smallest_x][smallest_y]].corners;
+    int start = (smallest_x ? 0 : axisBit(u)) + (smallest_y ? 0 : axisBit(v));
+    if (!(((corners >> start) ^ (corners >> (start + axisBit(axis)))) & 1))
+        return;
+    bool above_0 = corners >> start & 1;
+
+    // counterclockwise seen from the end of the edge, facing the higher values. The edge is on
+    // the side of each leaf facing the others, which is an edge of the cube for a single cell.
+    EdgeLeaf quad[4];
+    const int xy[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    for (int q = 0; q < 4; q++) {
+        int x = xy[q][0], y = xy[q][1];
+        int edge_start = (x ? 0 : axisBit(u)) + (y ? 0 : axisBit(v));
+        quad[q].leaf = around[x][y];
+        quad[q].edge = cubeEdge(edge_start, edge_start + axisBit(axis));
+    }
+    if (above_0)
+        std::swap(quad[1], quad[3]);
+    quads.insert(quads.end(), quad, quad + 4);
+}
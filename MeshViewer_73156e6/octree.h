@@ -0,0 +1,87 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#ifndef __MeshViewer_octree_h_
+#define __MeshViewer_octree_h_
+#include <atomic>
+#include <vector>
+#include "bricks.h"
+#include "grid.h"
+#include "scalar.h"
+
+// Octree over the cells of a volume whose leaves are as large as the surface allows: a node is
+// kept whole when the trilinear interpolation of its corners is close enough to its samples
+// (within a tolerance in voxels, measured near the surface), has the same sign at all of them
+// and leaves a single sheet of surface in the node. Regions without surface are single leaves.
+// Contouring follows Ju et al., "Dual Contouring of Hermite Data": each minimal edge crossed by
+// the surface (an edge of a leaf that is not split by a smaller one around it) joins the leaves
+// around it, so there are no cracks between leaves of different sizes.
+class Octree {
+ public:
+  struct Node {
+    int i, j, k;            // lowest sample of the node
+    int size;               // cells along each axis, a power of two
+    int children;           // first of its 8 children (child c at corner c), LEAF or OUTSIDE
+    unsigned char corners;  // marching cubes case of the corners of a leaf
+  };
+  static const int LEAF = -1;
+  static const int OUTSIDE = -2; // beyond the cells of the volume, never contoured
+
+  // the subtrees are no longer built once *cancel is set, leaving the tree unfinished
+  void build(const void *data, VolumeType type, const Grid &grid, const MinMaxBricks &bricks, float isovalue,
+             float tolerance, int n_threads, const std::atomic<bool> *cancel = nullptr);
+  void clear() {nodes.clear();}
+
+  // a leaf around a minimal edge, and the edge of its cube that the minimal edge is, when the
+  // leaf is a single cell (a larger leaf may have it in the middle of a face)
+  struct EdgeLeaf {
+    int leaf;
+    int edge;  // as in MC_EDGES
+  };
+  // leaves around each minimal edge crossed by the surface, 4 per edge (a leaf around the edge
+  // twice for a triangle, next to itself), counterclockwise seen from the side of the higher
+  // values like the marching cubes triangles
+  void contour(std::vector<EdgeLeaf> &quads) const;
+
+  const Node &node(int n) const {return nodes[n];}
+  int size() const {return nodes.size();}
+  // bytes used by the nodes
+  size_t memory() const {return nodes.capacity() * sizeof(Node);}
+
+ private:
+  // subtrees of this many cells along each axis are built on their own by the worker threads
+  static const int TASK_SIZE = 32;
+  std::vector<Node> nodes;
+
+  template <typename T>
+  void build(const T *data, const Grid &grid, const MinMaxBricks &bricks, float isovalue, float tolerance,
+             int n_threads, const std::atomic<bool> *cancel);
+  template <typename T>
+  void buildNode(std::vector<Node> &nodes, int n, const T *data, const Grid &grid, const MinMaxBricks &bricks,
+                 float isovalue, float tolerance) const;
+  template <typename T>
+  bool keepWhole(const Node &node, const T *data, const Grid &grid, float isovalue, float tolerance) const;
+
+  int child(int n, int corner) const {return nodes[n].children == LEAF ? n : nodes[n].children + corner;}
+  void cellProc(int n, std::vector<EdgeLeaf> &quads) const;
+  void faceProc(int n_0, int n_1, int axis, std::vector<EdgeLeaf> &quads) const;
+  void edgeProc(const int around[2][2], int axis, std::vector<EdgeLeaf> &quads) const;
+};
+
+#endif // __MeshViewer_octree_h_
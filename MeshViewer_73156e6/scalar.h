@@ -0,0 +1,114 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#ifndef __MeshViewer_scalar_h_
+#define __MeshViewer_scalar_h_
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+// Scalar type of the samples of a volume. Samples are kept in their own type and only
+// converted to float when they are compared or interpolated.
+enum VolumeType {VOLUME_FLOAT32 = 0, VOLUME_FLOAT16, VOLUME_UINT8, VOLUME_UINT16, VOLUME_INT16, VOLUME_TYPE_COUNT};
+
+// IEEE 754 half precision float, stored as its bits
+struct half {
+  uint16_t bits;
+};
+
+inline float halfToFloat(uint16_t h) {
+    uint32_t sign = (h & 0x8000u) << 16, exponent = (h >> 10) & 0x1f, mantissa = h & 0x3ff;
+    uint32_t bits;
+    if (exponent == 0x1f) {
+        bits = sign | 0x7f800000u | mantissa << 13;            // inf, nan
+    } else if (exponent != 0) {
+        bits = sign | (exponent + 112) << 23 | mantissa << 13;  // normal
+    } else if (mantissa != 0) {
+        // subnormal: normalize the mantissa
+        exponent = 113;
+        while (!(mantissa & 0x400)) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | exponent << 23 | (mantissa & 0x3ff) << 13;
+    } else {
+        bits = sign;                                           // zero
+    }
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// rounds to the nearest half, ties to even
+inline uint16_t floatToHalf(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    uint16_t sign = (bits >> 16) & 0x8000;
+    uint32_t abs_bits = bits & 0x7fffffffu;
+    if (abs_bits >= 0x7f800000u)                               // inf, nan
+        return sign | 0x7c00 | (abs_bits > 0x7f800000u ? 0x200 : 0);
+    if (abs_bits >= 0x477ff000u)                               // rounds above the largest half
+        return sign | 0x7c00;
+    if (abs_bits < 0x38800000u) {
+        // subnormal half: the value is a multiple of 2^-24, rounded to nearest even
+        float magnitude;
+        std::memcpy(&magnitude, &abs_bits, sizeof(magnitude));
+        return sign | (uint16_t) std::nearbyint(magnitude * 16777216.f);
+    }
+    uint32_t rounded = abs_bits + 0xfff + ((abs_bits >> 13) & 1);
+    return sign | (uint16_t) ((rounded - (112u << 23)) >> 13);
+}
+
+inline float toFloat(float v) {return v;}
+inline float toFloat(half v) {return halfToFloat(v.bits);}
+inline float toFloat(uint8_t v) {return v;}
+inline float toFloat(uint16_t v) {return v;}
+inline float toFloat(int16_t v) {return v;}
+
+// conversion of a float to each type, rounded to nearest and clamped to its range
+template <typename T> T fromFloat(float v);
+template <> inline float fromFloat<float>(float v) {return v;}
+template <> inline half fromFloat<half>(float v) {return half{floatToHalf(v)};}
+template <> inline uint8_t fromFloat<uint8_t>(float v) {return (uint8_t) std::fmin(std::fmax(std::nearbyint(v), 0.f), 255.f);}
+template <> inline uint16_t fromFloat<uint16_t>(float v) {return (uint16_t) std::fmin(std::fmax(std::nearbyint(v), 0.f), 65535.f);}
+template <> inline int16_t fromFloat<int16_t>(float v) {return (int16_t) std::fmin(std::fmax(std::nearbyint(v), -32768.f), 32767.f);}
+
+inline size_t volumeTypeSize(VolumeType type) {
+    static const size_t sizes[VOLUME_TYPE_COUNT] = {4, 2, 1, 2, 2};
+    return sizes[type];
+}
+
+inline const char *volumeTypeName(VolumeType type) {
+    static const char *names[VOLUME_TYPE_COUNT] = {"float32", "float16", "uint8", "uint16", "int16"};
+    return names[type];
+}
+
+// sample s of an array of samples of the given type
+inline float sampleValue(const void *data, VolumeType type, size_t s) {
+    switch (type) {
+    case VOLUME_FLOAT16: return toFloat(((const half *) data)[s]);
+    case VOLUME_UINT8:   return toFloat(((const uint8_t *) data)[s]);
+    case VOLUME_UINT16:  return toFloat(((const uint16_t *) data)[s]);
+    case VOLUME_INT16:   return toFloat(((const int16_t *) data)[s]);
+    default:             return toFloat(((const float *) data)[s]);
+    }
+}
+
+#endif // __MeshViewer_scalar_h_
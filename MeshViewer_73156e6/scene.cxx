@@ -20,20 +20,35 @@
 #include "scene.h"
 
 #include <OpenMesh/Core/Utils/vector_cast.hh>
-#include <fstream>
+#include <glm/gtc/type_ptr.hpp>
 #include <iostream>
-#include <unordered_map>
+#include <algorithm>
+#include <climits>
+#include <numeric>
+#include <thread>
 
+#include "classify.h"
 #include "utils.h"
 
 Scene::Scene() {
     thr = 1.1f;
     data = nullptr;
+    data_type = VOLUME_FLOAT32;
     _min_value = INFINITY;
     _max_value = -INFINITY;
+    _volume_loaded = false;
     isovalue = -INFINITY;
-    cell_size = 1.f;
-    cases = MCcases();
+    num_threads = 0;
+    output_mode = HALFEDGE_MESH;
+    normal_mode = FACE_NORMALS;
+    extraction_method = MARCHING_CUBES;
+    adaptive_tolerance = 0.1f;
+    incremental_updates = true;
+    collect_stats = false;
+    cancel_flag = nullptr;
+    volume_cache = std::make_shared<VolumeCache>();
+    last_surface.isovalue = isovalue;
+    last_surface.n_bricks = 0;
 }
 
 Scene::~Scene() {}
@@ -85,156 +100,1210 @@ bool Scene::load(const char *name) {
 int Scene::loadVolume(const char *name) {
     int loaded_meshes = 0;
 
-    std::ifstream volume_file(name);
-    int N = 0;
-
-    if (volume_file.is_open()) {
+    _stats.clear();
+    if (initializeData(name)) {
         _volume_names.push_back(std::string(name));
-        volume_file >> N;
 
-        // float data[N][N][N];
-        initializeData(volume_file, N);
+        float threshold = _min_value + (_max_value - _min_value) / thr;
+        float scale_factor = std::min({grid.spacing[0], grid.spacing[1], grid.spacing[2]}) /
+                             std::max({grid.dims[0], grid.dims[1], grid.dims[2]});
+        for (int i = 0; i < grid.dims[0]; i++) {
+            for (int j = 0; j < grid.dims[1]; j++) {
+                for (int k = 0; k < grid.dims[2]; k++) {
+                    if (sampleValue(data, data_type, grid.index(i, j, k)) <= threshold) {
+                        loaded_meshes++;
+                        addOctahedron(OpenMesh::Vec3d(grid.origin[0] + i * grid.spacing[0],
+                                                      grid.origin[1] + j * grid.spacing[1],
+                                                      grid.origin[2] + k * grid.spacing[2]), scale_factor);
+                    }
+                }
+            }
+        }
+    }
+
+    return loaded_meshes;
+}
+
+bool Scene::computeVolumeIsosurface(const char *name, bool preview) {
+    _stats.clear();
+    if (!parseVolume(name, preview)) return false;
+
+    IsoSurface surface;
+    if (!extractIsosurface(surface))
+        return false;
+
+    if (output_mode == HALFEDGE_MESH) {
+        MyMesh m;
+        buildMesh(surface, m, normal_mode == GRADIENT_NORMALS, collectedStats());
+        _meshes.push_back(std::pair<MyMesh, ColorInfo>(std::move(m), FACE_COLORS));
+    } else {
+        if (output_mode == INTERLEAVED_BUFFERS) {
+            StageTimer timer(collectedStats(), ExtractionStats::MESH);
+            interleaveVertices(surface);
+        }
+        _surfaces.push_back(std::move(surface));
+    }
+
+    return true;
+}
+
+bool Scene::computeVolumeIsosurfaces(const char *name, const std::vector<float> &isovalues) {
+    _stats.clear();
+    if (!parseVolume(name) || !grid.valid()) return false;
+
+    // the levels are extracted in increasing order, and the surfaces returned in the given one
+    std::vector<size_t> order(isovalues.size());
+    for (size_t l = 0; l < order.size(); l++)
+        order[l] = l;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {return isovalues[a] < isovalues[b];});
+    std::vector<float> levels(isovalues.size());
+    for (size_t l = 0; l < order.size(); l++)
+        levels[l] = isovalues[order[l]];
+
+    std::vector<IsoSurface> sorted_surfaces(levels.size());
+    if (extraction_method == MARCHING_CUBES) {
+        extractLevels(levels, sorted_surfaces);
+    } else {
+        // the other methods extract each level on its own
+        float current_isovalue = isovalue;
+        for (size_t l = 0; l < levels.size(); l++) {
+            isovalue = levels[l];
+            extractIsosurface(sorted_surfaces[l]);
+        }
+        isovalue = current_isovalue;
+    }
+    if (cancelled())
+        return false;
+    std::vector<IsoSurface> surfaces(levels.size());
+    for (size_t l = 0; l < order.size(); l++)
+        surfaces[order[l]] = std::move(sorted_surfaces[l]);
+
+    for (IsoSurface &surface : surfaces) {
+        if (output_mode == HALFEDGE_MESH) {
+            MyMesh m;
+            buildMesh(surface, m, normal_mode == GRADIENT_NORMALS, collectedStats());
+            _meshes.push_back(std::pair<MyMesh, ColorInfo>(std::move(m), FACE_COLORS));
+        } else {
+            if (output_mode == INTERLEAVED_BUFFERS) {
+                StageTimer timer(collectedStats(), ExtractionStats::MESH);
+                interleaveVertices(surface);
+            }
+            _surfaces.push_back(std::move(surface));
+        }
+    }
+
+    return true;
+}
+
+void Scene::buildMesh(const IsoSurface &surface, MyMesh &m, bool vertex_normals, ExtractionStats *stats) {
+    {
+        StageTimer timer(stats, ExtractionStats::MESH);
+        m.reserve(surface.n_vertices(), surface.n_vertices() + surface.n_triangles(), surface.n_triangles());
+        for (size_t v = 0; v < surface.positions.size(); v += 3) {
+            MyMesh::VertexHandle vh = m.add_vertex(MyMesh::Point(surface.positions[v], surface.positions[v + 1], surface.positions[v + 2]));
+            if (vertex_normals)
+                m.set_normal(vh, MyMesh::Normal(surface.normals[v], surface.normals[v + 1], surface.normals[v + 2]));
+        }
+
+        std::vector<MyMesh::VertexHandle> face_vhandles(3);
+        for (size_t t = 0; t < surface.indices.size(); t += 3) {
+            for (int v = 0; v < 3; v++)
+                face_vhandles[v] = MyMesh::VertexHandle(surface.indices[t + v]);
+            // OpenMesh rejects the faces that would make the mesh non-manifold, which the dual
+            // methods may still produce (see ExtractionMethod)
+            MyMesh::FaceHandle face = m.add_face(face_vhandles);
+            if (face.is_valid())
+                m.set_color(face, MyMesh::Color(0.6, 0.6, 0.6));
+        }
+    }
+    // the vertex normals given by the surface are kept, only the faces need theirs
+    StageTimer timer(stats, ExtractionStats::NORMALS);
+    if (vertex_normals)
+        m.update_face_normals();
+    else
+        m.update_normals();
+}
+
+void Scene::interleaveVertices(IsoSurface &surface) const {
+    // each vertex is written once, with the gray of the faces of the meshes, split among the
+    // threads like moveVertices
+    size_t n = surface.positions.size() / 3;
+    bool has_normals = surface.normals.size() == surface.positions.size();
+    surface.vertices.resize(n);
+    auto pack = [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; v++) {
+            InterleavedVertex &vertex = surface.vertices[v];
+            for (int c = 0; c < 3; c++) {
+                vertex.position[c] = surface.positions[3*v + c];
+                vertex.normal[c] = has_normals ? surface.normals[3*v + c] : 0.f;
+                vertex.color[c] = 153;
+            }
+            vertex.color[3] = 255;
+        }
+    };
+
+    int n_threads = num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+    if (n_threads == 1 || n < 4096) {
+        pack(0, n);
+    } else {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < n_threads; t++)
+            workers.emplace_back(pack, n * t / n_threads, n * (t + 1) / n_threads);
+        for (std::thread &w : workers)
+            w.join();
+    }
+    std::vector<float>().swap(surface.positions);
+    std::vector<float>().swap(surface.normals);
+}
+
+bool Scene::extractIsosurface(IsoSurface &surface) {
+    if (!grid.valid()) return false;
+
+    // when only the isovalue changed, the triangles of the bricks where the surface keeps its
+    // connectivity are reused, unless too many bricks change (marching cubes only)
+    bool updated = false;
+    if (incremental_updates && extraction_method == MARCHING_CUBES && last_surface.volume.lock() == volume) {
+        StageTimer timer(collectedStats(), ExtractionStats::UPDATE);
+        switch (data_type) {
+        case VOLUME_FLOAT16: updated = updateChangedBricks<half>(surface); break;
+        case VOLUME_UINT8:   updated = updateChangedBricks<uint8_t>(surface); break;
+        case VOLUME_UINT16:  updated = updateChangedBricks<uint16_t>(surface); break;
+        case VOLUME_INT16:   updated = updateChangedBricks<int16_t>(surface); break;
+        default:             updated = updateChangedBricks<float>(surface); break;
+        }
+    }
+    if (!updated)
+        extractAllBricks(surface);
+    if (cancelled()) {
+        // the surface was left unfinished, so the next one is extracted from scratch
+        last_surface.volume.reset();
+        return false;
+    }
+
+    // the surface is only kept when the next one may be updated from it
+    if (incremental_updates && extraction_method == MARCHING_CUBES) {
+        last_surface.volume = volume;
+        last_surface.isovalue = isovalue;
+        last_surface.indices = surface.indices;
+        std::vector<char> has_triangles(volume->bricks.count(), 0);
+        for (size_t cell : last_surface.triangle_cells)
+            has_triangles[cellBrick(cell)] = 1;
+        last_surface.n_bricks = std::count(has_triangles.begin(), has_triangles.end(), 1);
+    } else {
+        last_surface.volume.reset();
+        std::vector<long long>().swap(last_surface.vertex_edges);
+        std::vector<uint32_t>().swap(last_surface.indices);
+        std::vector<size_t>().swap(last_surface.triangle_cells);
+    }
+
+    _stats.add(ExtractionStats::VERTICES, surface.n_vertices());
+    _stats.add(ExtractionStats::TRIANGLES, surface.n_triangles());
+
+    // check that mesh is not empty
+    if (surface.n_vertices() == 0)
+        return false;
+
+    if (normal_mode == FACE_NORMALS) {
+        StageTimer timer(collectedStats(), ExtractionStats::NORMALS);
+        computeNormals(surface);
+    }
+    return true;
+}
 
-        float max_value = -INFINITY;
-        float min_value = INFINITY;
+template <typename T>
+bool Scene::updateChangedBricks(IsoSurface &surface) {
+    const MinMaxBricks &bricks = volume->bricks;
+    const int Ni = grid.dims[0], Nj = grid.dims[1], Nk = grid.dims[2];
+    const int S = MinMaxBricks::SIZE;
+    const T *samples = (const T *) data;
+    float lo = std::min(last_surface.isovalue, isovalue), hi = std::max(last_surface.isovalue, isovalue);
 
-        for (int i = 0; i < N; i++) {
-            for (int j = 0; j < N; j++) {
-                for (int k = 0; k < N; k++) {
-                    volume_file >> data[i*N*N + j*N + k];
+    // a cell keeps its case, and so its triangles, unless one of its samples is in (lo, hi], i.e.
+    // changes side of the surface. Only bricks whose range meets that interval can hold one.
+    std::vector<char> changed(bricks.count(), 0);
+    std::vector<int> changed_bricks;
+    size_t max_changed = std::max(1, last_surface.n_bricks / 4);
+    for (int bi = 0; bi < bricks.size(0); bi++) {
+        for (int bj = 0; bj < bricks.size(1); bj++) {
+            for (int bk = 0; bk < bricks.size(2); bk++) {
+                int b = bricks.index(bi, bj, bk);
+                if (bricks.max(b) <= lo || bricks.min(b) > hi)
+                    continue;
 
-                    max_value = std::max(max_value, data[i*N*N + j*N + k]);
-                    min_value = std::min(min_value, data[i*N*N + j*N + k]);
+                bool crossed = false;
+                int k_end = std::min(Nk, (bk + 1) * S + 1);
+                for (int i = bi * S; i < std::min(Ni, (bi + 1) * S + 1) && !crossed; i++) {
+                    for (int j = bj * S; j < std::min(Nj, (bj + 1) * S + 1) && !crossed; j++) {
+                        const T *row = samples + grid.index(i, j, 0);
+                        for (int k = bk * S; k < k_end; k++) {
+                            float f = toFloat(row[k]);
+                            crossed |= f > lo && f <= hi;
+                        }
+                    }
                 }
+                if (!crossed)
+                    continue;
+
+                // re-extracting most bricks is slower than extracting them all
+                changed[b] = 1;
+                changed_bricks.push_back(b);
+                if (changed_bricks.size() > max_changed)
+                    return false;
             }
         }
+    }
 
-        volume_file.close();
-        float threshold = min_value + (max_value - min_value) / thr;
-        float scale_factor = 1.f / (N * N);
-        for (int i = 0; i < N; i++) {
-            for (int j = 0; j < N; j++) {
-                for (int k = 0; k < N; k++) {
-                    if (data[i*N*N + j*N + k] <= threshold) {
-                        loaded_meshes++;
-                        addOctahedron(OpenMesh::Vec3d(i / float(N), j / float(N), k / float(N)), scale_factor);
+    // triangles of the unchanged bricks are kept as they are. The vertices of the others that
+    // are on the faces of their brick may be shared with an unchanged brick, so the new
+    // triangles reuse them.
+    std::vector<long long> &vertex_edges = last_surface.vertex_edges;
+    std::vector<size_t> triangle_cells;
+    triangle_cells.reserve(last_surface.triangle_cells.size());
+    std::vector<uint32_t> indices;
+    indices.reserve(last_surface.indices.size());
+    EdgeMap old_vertices;
+    old_vertices.reserve(changed_bricks.size()*S*S*3);
+    for (size_t t = 0; t < last_surface.triangle_cells.size(); t++) {
+        const uint32_t *triangle = &last_surface.indices[3*t];
+        if (!changed[cellBrick(last_surface.triangle_cells[t])]) {
+            indices.insert(indices.end(), triangle, triangle + 3);
+            triangle_cells.push_back(last_surface.triangle_cells[t]);
+            continue;
+        }
+        for (int v = 0; v < 3; v++) {
+            int sample[3], axis;
+            decodeEdge(vertex_edges[triangle[v]], sample, axis);
+            if (sample[(axis + 1) % 3] % S == 0 || sample[(axis + 2) % 3] % S == 0) {
+                uint32_t id = triangle[v];
+                old_vertices.insert(vertex_edges[id], id);
+            }
+        }
+    }
+
+    // the changed bricks are extracted again, after the kept triangles. Edges are found in a
+    // dense index of the brick, then among the old vertices.
+    const size_t n_kept = triangle_cells.size();
+    std::vector<unsigned char> cases(S);
+    std::vector<int> active(S);
+    std::vector<int> brick_edges((S + 1)*(S + 1)*(S + 1)*3);
+    size_t n_active_cells = 0, n_lookups = 0;
+    for (int b : changed_bricks) {
+        // an unfinished surface is dropped by extractIsosurface
+        if (cancelled())
+            return true;
+        if (!bricks.active(b, isovalue))
+            continue;
+        int bk = b % bricks.size(2), bj = b / bricks.size(2) % bricks.size(1), bi = b / bricks.size(2) / bricks.size(1);
+        int k_begin = bk * S, k_end = std::min((bk + 1) * S, Nk - 1);
+        std::fill(brick_edges.begin(), brick_edges.end(), -1);
+        for (int i = bi * S; i < std::min((bi + 1) * S, Ni - 1); i++) {
+            for (int j = bj * S; j < std::min((bj + 1) * S, Nj - 1); j++) {
+                const T *row = samples + grid.index(i, j, k_begin);
+                int n_active = classifyRow(row, row + Nk, row + Nj*Nk, row + Nj*Nk + Nk, k_end - k_begin, isovalue,
+                                           cases.data(), active.data());
+                n_active_cells += n_active;
+
+                for (int a = 0; a < n_active; a++) {
+                    int k = k_begin + active[a];
+                    const MCcase &recons = MC_CASES[cases[active[a]]];
+                    n_lookups += 3*recons.n_triangles;
+                    for (int t = 0; t < recons.n_triangles; t++) {
+                        for (int v = 0; v < 3; v++) {
+                            int origin[3], axis;
+                            cellEdge(recons.edges[3*t + v], origin, axis);
+                            // sample at which the edge starts, relative to the brick
+                            int d[3] = {i - bi * S + origin[0], j - bj * S + origin[1], k - bk * S + origin[2]};
+                            int &vtx_idx = brick_edges[((d[0]*(S + 1) + d[1])*(S + 1) + d[2])*3 + axis];
+                            if (vtx_idx < 0) {
+                                // edges seen for the first time get a new vertex, placed below,
+                                // unless they are on a face and another brick has one already
+                                long long edge = (long long) grid.index(i + origin[0], j + origin[1], k + origin[2])*3 + axis;
+                                uint32_t id = vertex_edges.size();
+                                bool face = d[(axis + 1) % 3] % S == 0 || d[(axis + 2) % 3] % S == 0;
+                                if (!face || old_vertices.insert(edge, id))
+                                    vertex_edges.push_back(edge);
+                                vtx_idx = id;
+                            }
+                            indices.push_back(vtx_idx);
+                        }
+                        triangle_cells.push_back(grid.index(i, j, k));
                     }
                 }
             }
         }
     }
 
-    return loaded_meshes;
+    // the triangles are put in the order of their cells, and the vertices in the order the
+    // triangles first use them, as a full extraction does, so that the surface of an isovalue
+    // does not depend on the ones extracted before it. The kept triangles are in that order
+    // already, and a cell has either kept or new triangles, so only the new ones are sorted.
+    std::vector<uint32_t> new_triangles(triangle_cells.size() - n_kept);
+    std::iota(new_triangles.begin(), new_triangles.end(), (uint32_t) n_kept);
+    std::stable_sort(new_triangles.begin(), new_triangles.end(),
+                     [&](uint32_t a, uint32_t b) {return triangle_cells[a] < triangle_cells[b];});
+
+    // vertices no longer used are dropped
+    const uint32_t NO_VERTEX = UINT32_MAX;
+    std::vector<uint32_t> new_ids(vertex_edges.size(), NO_VERTEX);
+    std::vector<long long> used_edges;
+    used_edges.reserve(vertex_edges.size());
+    surface.indices.resize(indices.size());
+    last_surface.triangle_cells.resize(triangle_cells.size());
+    size_t kept = 0, added = 0;
+    for (size_t t = 0; t < triangle_cells.size(); t++) {
+        bool take_kept = added == new_triangles.size() ||
+                         (kept < n_kept && triangle_cells[kept] < triangle_cells[new_triangles[added]]);
+        uint32_t from = take_kept ? kept++ : new_triangles[added++];
+        last_surface.triangle_cells[t] = triangle_cells[from];
+        for (int v = 0; v < 3; v++) {
+            uint32_t &id = new_ids[indices[3*from + v]];
+            if (id == NO_VERTEX) {
+                id = used_edges.size();
+                used_edges.push_back(vertex_edges[indices[3*from + v]]);
+            }
+            surface.indices[3*t + v] = id;
+        }
+    }
+    vertex_edges.swap(used_edges);
+
+    // all the vertices are placed for the new isovalue
+    surface.positions.resize(3*vertex_edges.size());
+    surface.normals.resize(normal_mode == GRADIENT_NORMALS ? 3*vertex_edges.size() : 0);
+    moveVertices<T>(vertex_edges, surface);
+
+    _stats.add(ExtractionStats::ACTIVE_CELLS, n_active_cells);
+    _stats.add(ExtractionStats::EDGE_LOOKUPS, n_lookups);
+    _stats.add(ExtractionStats::HASH_PROBES, old_vertices.n_probes);
+    return true;
+}
+
+template <typename T>
+void Scene::moveVertices(const std::vector<long long> &vertex_edges, IsoSurface &surface) {
+    // positions (and normals) of the vertices for the current isovalue, split among the threads
+    auto move = [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; v++) {
+            int c[3], axis;
+            decodeEdge(vertex_edges[v], c, axis);
+            edgePoint<T>(c[0], c[1], c[2], axis, isovalue, &surface.positions[3*v],
+                         normal_mode == GRADIENT_NORMALS ? &surface.normals[3*v] : nullptr);
+        }
+    };
+
+    size_t n = vertex_edges.size();
+    int n_threads = num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+    if (n_threads == 1 || n < 4096) {
+        move(0, n);
+    } else {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < n_threads; t++)
+            workers.emplace_back(move, n * t / n_threads, n * (t + 1) / n_threads);
+        for (std::thread &w : workers)
+            w.join();
+    }
 }
 
-bool Scene::computeVolumeIsosurface(const char *name) {
-    std::ifstream volume_file(name);
-    int N = 0;
+int Scene::cellBrick(size_t cell) const {
+    const int S = MinMaxBricks::SIZE;
+    int k = cell % grid.dims[2], j = cell / grid.dims[2] % grid.dims[1], i = cell / grid.dims[2] / grid.dims[1];
+    return volume->bricks.index(i / S, j / S, k / S);
+}
 
-    if (!parseVolume(name, volume_file, N)) return false;
+void Scene::decodeEdge(long long edge, int sample[3], int &axis) const {
+    axis = edge % 3;
+    long long index = edge / 3;
+    sample[2] = index % grid.dims[2];
+    sample[1] = index / grid.dims[2] % grid.dims[1];
+    sample[0] = index / grid.dims[2] / grid.dims[1];
+}
 
-    bool bin_data[N*N*N];
-    for (int i = 0; i < N*N*N; i++)
-        bin_data[i] = data[i] > isovalue;
+void Scene::extractAllBricks(IsoSurface &surface) {
+    const int Ni = grid.dims[0];
 
-    MyMesh m;
+    // bricks that may be crossed by the surface, in the order they are traversed
+    volume->span_space.activeBricks(isovalue, active_bricks);
+
+    // split the cells into slabs along i (the slowest axis, so each slab reads a contiguous
+    // part of the volume) and extract each of them on its own thread
+    int n_slabs = num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+    n_slabs = std::min(n_slabs, Ni - 1);
+    // the octree covers the whole volume, and shares its work among the threads itself
+    if (extraction_method == ADAPTIVE_DUAL_CONTOURING)
+        n_slabs = 1;
+    std::vector<Slab> slabs(n_slabs);
+    for (int s = 0; s < n_slabs; s++) {
+        slabs[s].i_begin = (Ni - 1) * s / n_slabs;
+        slabs[s].i_end = (Ni - 1) * (s + 1) / n_slabs;
+    }
+
+    switch (data_type) {
+    case VOLUME_FLOAT16: extractSlabs<half>(slabs); break;
+    case VOLUME_UINT8:   extractSlabs<uint8_t>(slabs); break;
+    case VOLUME_UINT16:  extractSlabs<uint16_t>(slabs); break;
+    case VOLUME_INT16:   extractSlabs<int16_t>(slabs); break;
+    default:             extractSlabs<float>(slabs); break;
+    }
+
+    StageTimer timer(collectedStats(), ExtractionStats::STITCH);
+    stitchSlabs(slabs, surface, last_surface.vertex_edges, last_surface.triangle_cells);
+}
+
+void Scene::extractLevels(const std::vector<float> &levels, std::vector<IsoSurface> &surfaces) {
+    const int Ni = grid.dims[0];
+    if (levels.empty()) return;
+    const MinMaxBricks &bricks = volume->bricks;
+
+    // bricks whose range contains some of the levels
+    std::vector<char> level_bricks(bricks.count());
+    for (int b = 0; b < bricks.count(); b++)
+        level_bricks[b] = std::lower_bound(levels.begin(), levels.end(), bricks.min(b)) !=
+                          std::lower_bound(levels.begin(), levels.end(), bricks.max(b));
+
+    // the same slabs as extractAllBricks, each one extracting all the levels
+    int n_slabs = num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+    n_slabs = std::min(n_slabs, Ni - 1);
+    std::vector<std::vector<Slab> > slabs(levels.size(), std::vector<Slab>(n_slabs));
+    for (std::vector<Slab> &level_slabs : slabs) {
+        for (int s = 0; s < n_slabs; s++) {
+            level_slabs[s].i_begin = (Ni - 1) * s / n_slabs;
+            level_slabs[s].i_end = (Ni - 1) * (s + 1) / n_slabs;
+        }
+    }
 
-    cell_size = 1.f / N;
+    switch (data_type) {
+    case VOLUME_FLOAT16: extractLevelSlabs<half>(levels, level_bricks, slabs); break;
+    case VOLUME_UINT8:   extractLevelSlabs<uint8_t>(levels, level_bricks, slabs); break;
+    case VOLUME_UINT16:  extractLevelSlabs<uint16_t>(levels, level_bricks, slabs); break;
+    case VOLUME_INT16:   extractLevelSlabs<int16_t>(levels, level_bricks, slabs); break;
+    default:             extractLevelSlabs<float>(levels, level_bricks, slabs); break;
+    }
+
+    std::vector<long long> vertex_edges;
+    std::vector<size_t> triangle_cells;
+    for (size_t l = 0; l < levels.size(); l++) {
+        {
+            StageTimer timer(collectedStats(), ExtractionStats::STITCH);
+            stitchSlabs(slabs[l], surfaces[l], vertex_edges, triangle_cells);
+            std::vector<Slab>().swap(slabs[l]);
+        }
+        _stats.add(ExtractionStats::VERTICES, surfaces[l].n_vertices());
+        _stats.add(ExtractionStats::TRIANGLES, surfaces[l].n_triangles());
+        if (normal_mode == FACE_NORMALS) {
+            StageTimer timer(collectedStats(), ExtractionStats::NORMALS);
+            computeNormals(surfaces[l]);
+        }
+    }
+}
 
-    // dictionary with pair of edge endpoint indices as key (global flattened indices), and Vertex handle as values.
-    std::unordered_map<std::pair<int, int>, MyMesh::VertexHandle, hash_pair> edge_to_vtx_dict;
-    for (int i = 0; i < N - 1; i++) {
-        for (int j = 0; j < N - 1; j++) {
-            for (int k = 0; k < N - 1; k++) {
-                int MC_config = 0;
+void Scene::stitchSlabs(const std::vector<Slab> &slabs, IsoSurface &surface, std::vector<long long> &vertex_edges,
+                        std::vector<size_t> &triangle_cells) const {
+    const int Nj = grid.dims[1], Nk = grid.dims[2];
+
+    // stitch the slabs in order. Only points lying on the plane shared with the previous slab
+    // can be duplicated, and the previous slab always creates them first, so the vertex and
+    // triangle order is the same as in a single-threaded extraction.
+    size_t n_points = 0, n_triangles = 0;
+    for (const Slab &slab : slabs) {
+        n_points += slab.points.size();
+        n_triangles += slab.triangles.size();
+    }
+    surface.positions.reserve(n_points);
+    if (normal_mode == GRADIENT_NORMALS)
+        surface.normals.reserve(n_points);
+    surface.indices.reserve(n_triangles);
+    vertex_edges.clear();
+    triangle_cells.clear();
 
-                // get configuration for cube (i,j,k) -> (i+1,j+1,k+1)
-                for (int n = 0; n < 8; n++)
-                    MC_config += bin_data[(i + n / 4) * N*N + (j + (n % 4) / 2)*N + (k + n % 2)] * pow(2, n);
+    // three edges per sample, or the points of up to four components per cell (dual methods)
+    bool dual = extraction_method != MARCHING_CUBES && extraction_method != ASYMPTOTIC_DECIDER;
+    const long long plane_edges = (dual ? 4LL : 3LL)*Nj*Nk;
+    std::vector<int> boundary(plane_edges, -1), next_boundary(plane_edges);
+    std::vector<uint32_t> local_to_global;
+    for (const Slab &slab : slabs) {
+        local_to_global.resize(slab.point_edges.size());
+        std::fill(next_boundary.begin(), next_boundary.end(), -1);
+        for (size_t v = 0; v < slab.point_edges.size(); v++) {
+            int plane = slab.point_edges[v] / plane_edges;
+            int slot = slab.point_edges[v] % plane_edges;
 
-                reconstructVoxel(MC_config, N, m, edge_to_vtx_dict, i, j, k);
+            if (plane == slab.i_begin && boundary[slot] >= 0) {
+                local_to_global[v] = boundary[slot];
+            } else {
+                local_to_global[v] = surface.n_vertices();
+                vertex_edges.push_back(slab.point_edges[v]);
+                surface.positions.insert(surface.positions.end(), &slab.points[3*v], &slab.points[3*v] + 3);
+                if (normal_mode == GRADIENT_NORMALS)
+                    surface.normals.insert(surface.normals.end(), &slab.normals[3*v], &slab.normals[3*v] + 3);
             }
+
+            if (plane == slab.i_end)
+                next_boundary[slot] = local_to_global[v];
         }
+        boundary.swap(next_boundary);
+
+        for (uint32_t v : slab.triangles)
+            surface.indices.push_back(local_to_global[v]);
+        triangle_cells.insert(triangle_cells.end(), slab.triangle_cells.begin(), slab.triangle_cells.end());
     }
+}
 
-    // check that mesh is not empty
-    if  (edge_to_vtx_dict.empty())
-        return false;
+void Scene::computeNormals(IsoSurface &surface) {
+    surface.normals.assign(surface.positions.size(), 0.f);
+    const glm::vec3 *p = (const glm::vec3 *) surface.positions.data();
+    glm::vec3 *n = (glm::vec3 *) surface.normals.data();
+    for (size_t t = 0; t < surface.indices.size(); t += 3) {
+        uint32_t a = surface.indices[t], b = surface.indices[t + 1], c = surface.indices[t + 2];
+        glm::vec3 face_normal = glm::cross(p[b] - p[a], p[c] - p[a]);
+        n[a] += face_normal;
+        n[b] += face_normal;
+        n[c] += face_normal;
+    }
+    for (size_t v = 0; v < surface.n_vertices(); v++) {
+        float length = glm::length(n[v]);
+        if (length > 0.f)
+            n[v] /= length;
+    }
+}
 
-    // update normals and append mesh
-    m.update_normals();
-    _meshes.push_back(std::pair<MyMesh, ColorInfo>(std::move(m), FACE_COLORS));
+template <typename T>
+void Scene::extractSlabs(std::vector<Slab> &slabs) {
+    bool dual = extraction_method == SURFACE_NETS || extraction_method == DUAL_CONTOURING;
+    void (Scene::*extract)(Slab &) = dual ? &Scene::extractDualSlab<T> : &Scene::extractSlab<T>;
+    if (extraction_method == ADAPTIVE_DUAL_CONTOURING)
+        extract = &Scene::extractOctree<T>;
+    if (slabs.size() == 1) {
+        (this->*extract)(slabs[0]);
+    } else {
+        std::vector<std::thread> workers;
+        for (Slab &slab : slabs)
+            workers.emplace_back(extract, this, std::ref(slab));
+        for (std::thread &w : workers)
+            w.join();
+    }
+    for (const Slab &slab : slabs)
+        _stats.merge(slab.stats);
+}
 
-    return true;
+template <typename T>
+void Scene::extractSlab(Slab &slab) {
+    const int Nj = grid.dims[1], Nk = grid.dims[2];
+    // slab point index of the edges of the current plane of cells
+    EdgeIndex edge_index(Nj, Nk);
+    // case of each cell of the current row, and cells of the row crossed by the surface
+    std::vector<unsigned char> cases(Nk);
+    std::vector<int> active(Nk);
+    // ranges of cells of the current row that lie in bricks containing the isovalue
+    std::vector<int> ranges;
+    int n_ranges = 0;
+    ExtractionStats *stats = collect_stats ? &slab.stats : nullptr;
+    size_t n_active_cells = 0;
+    bool resolve_ambiguities = extraction_method == ASYMPTOTIC_DECIDER;
+    for (int i = slab.i_begin; i < slab.i_end && !cancelled(); i++) {
+        edge_index.clearPlane(i + 1);
+        for (int j = 0; j < Nj - 1; j++) {
+            if (j % MinMaxBricks::SIZE == 0) {
+                ranges.clear();
+                n_ranges = active_bricks.cellRanges(i / MinMaxBricks::SIZE, j / MinMaxBricks::SIZE, Nk, ranges);
+            }
+
+            // get configuration for the row of cubes (i,j,k) -> (i+1,j+1,k+1), one range at a
+            // time, then triangulate its active cells (timing each range would cost more than
+            // the short ones take)
+            int n_active = 0;
+            {
+                StageTimer timer(stats, ExtractionStats::CLASSIFY);
+                for (int r = 0; r < n_ranges; r++) {
+                    int k_begin = ranges[2*r], k_end = ranges[2*r + 1];
+                    const T *row = (const T *) data + grid.index(i, j, k_begin);
+                    int n = classifyRow(row, row + Nk, row + Nj*Nk, row + Nj*Nk + Nk, k_end - k_begin, isovalue,
+                                        &cases[k_begin], &active[n_active]);
+                    for (int a = n_active; a < n_active + n; a++)
+                        active[a] += k_begin;
+                    n_active += n;
+                }
+            }
+            n_active_cells += n_active;
+
+            StageTimer timer(stats, ExtractionStats::TRIANGULATE);
+            for (int a = 0; a < n_active; a++) {
+                int k = active[a];
+                int MC_config = cases[k];
+                if (resolve_ambiguities && mcAmbiguousFaces(MC_config)) {
+                    const MCresolvedCase &recons = resolvedCase<T>(MC_config, i, j, k);
+                    reconstructVoxel<T>(recons.n_triangles, recons.edges, slab, edge_index, i, j, k,
+                                        recons.center_edges);
+                } else {
+                    // get reconstruction for given case: set of triangles using the edges at which the vertices should go
+                    const MCcase &recons = MC_CASES[MC_config];
+                    reconstructVoxel<T>(recons.n_triangles, recons.edges, slab, edge_index, i, j, k);
+                }
+            }
+        }
+    }
+    // every triangle corner looks its edge up in the edge index
+    slab.stats.add(ExtractionStats::ACTIVE_CELLS, n_active_cells);
+    slab.stats.add(ExtractionStats::EDGE_LOOKUPS, slab.triangles.size());
 }
 
-bool Scene::parseVolume(const char* name, std::ifstream &volume_file, int &N) {
-    if (volume_file.is_open()) {
+namespace {
+
+// Components of the surface in a cell: the loops in which its triangles in MC_CASES cross the faces
+// of the cube, each joining the crossed edges it goes through. The dual methods place a point for
+// each component rather than one for the whole cell, which would join two sheets of the surface
+// crossing the cell into a pinched vertex. A loop is a component of its own even when the
+// triangles of the case join it to another one with a tunnel through the cell, so that the quads
+// around the point close into a single fan.
+struct CellComponents {
+    unsigned char n_components;
+    unsigned short edges[4];    // crossed edges of each component
+    signed char component[12];  // component of each crossed edge, -1 for the others
+};
 
-        volume_file >> N;
+struct CellComponentCases {
+    CellComponents cases[256];
 
-        if (std::find(_volume_names.begin(), _volume_names.end(), name) == _volume_names.end()) {
-            initializeData(volume_file, N);
-            _volume_names.push_back(std::string(name));
-        } else _meshes.clear();
+    CellComponentCases() {
+        for (int MC_config = 0; MC_config < 256; MC_config++) {
+            const MCcase &recons = MC_CASES[MC_config];
+            CellComponents &components = cases[MC_config];
+            // the sides of the triangles that no other triangle shares lie on the faces of the
+            // cube, and join their crossed edges into the same component
+            int root[12];
+            std::iota(root, root + 12, 0);
+            auto find = [&](int e) {while (root[e] != e) e = root[e]; return e;};
+            const unsigned char *edges = recons.edges;
+            for (int s = 0; s < 3*recons.n_triangles; s++) {
+                int a = edges[s], b = edges[s - s % 3 + (s + 1) % 3], n_sharing = 0;
+                for (int r = 0; r < 3*recons.n_triangles; r++) {
+                    int c = edges[r], d = edges[r - r % 3 + (r + 1) % 3];
+                    n_sharing += (a == c && b == d) || (a == d && b == c);
+                }
+                if (n_sharing == 1)
+                    root[find(a)] = find(b);
+            }
 
-        volume_file.close();
-        return true;
+            int n = 0;
+            std::fill(components.component, components.component + 12, -1);
+            for (int e = 0; e < 12; e++) {
+                if (!(MC_EDGE_MASK[MC_config] >> e & 1))
+                    continue;
+                int c = components.component[find(e)];
+                if (c < 0) {
+                    c = components.component[find(e)] = n++;
+                    components.edges[c] = 0;
+                }
+                components.component[e] = c;
+                components.edges[c] |= 1 << e;
+            }
+            components.n_components = n;
+        }
+    }
+};
+
+const CellComponentCases cell_components;
 
-    } else return false;
 }
 
-void Scene::reconstructVoxel(int &MC_config, int &N, MyMesh &m, std::unordered_map<std::pair<int, int>, MyMesh::VertexHandle, hash_pair> &edge_to_vtx_dict, int &i, int &j, int &k) {
+template <typename T>
+void Scene::extractDualSlab(Slab &slab) {
+    const int Nj = grid.dims[1], Nk = grid.dims[2];
+    // first slab point index and case of the cells of two consecutive planes. The point of each
+    // component of a cell follows that of the one before.
+    std::vector<int> cell_points(2*(Nj - 1)*(Nk - 1));
+    std::vector<unsigned char> cell_cases(cell_points.size());
+    auto cellSlot = [&](int i, int j, int k) {return ((i & 1)*(Nj - 1) + j)*(Nk - 1) + k;};
+    // cube edge of the edge of a quad in each of the cells around it, in the order of the quad
+    int quad_edges[3][4];
+    for (int e = 0; e < 12; e++) {
+        int origin[3], axis;
+        cellEdge(e, origin, axis);
+        int u = (axis + 1) % 3, v = (axis + 2) % 3;
+        quad_edges[axis][origin[u] ? (origin[v] ? 0 : 3) : (origin[v] ? 1 : 2)] = e;
+    }
+    std::vector<unsigned char> cases(Nk);
+    std::vector<int> active(Nk);
+    std::vector<int> ranges;
+    int n_ranges = 0;
+    ExtractionStats *stats = collect_stats ? &slab.stats : nullptr;
+    size_t n_active_cells = 0;
 
-    // get reconstraction for given case: set of triangles using the edges at which the vertices should go
-    std::vector<std::vector<int>> recons = cases(MC_config);
+    // the quad of an edge is added with the last of the four cells around it, the one whose
+    // lowest corner is the start of the edge. The quads of the first plane of cells also need
+    // the cells of the plane before, which are placed again and joined to those of the previous
+    // slab when stitching.
+    for (int i = std::max(slab.i_begin - 1, 0); i < slab.i_end && !cancelled(); i++) {
+        std::fill(&cell_points[cellSlot(i, 0, 0)], &cell_points[cellSlot(i, 0, 0)] + (Nj - 1)*(Nk - 1), -1);
+        for (int j = 0; j < Nj - 1; j++) {
+            if (j % MinMaxBricks::SIZE == 0) {
+                ranges.clear();
+                n_ranges = active_bricks.cellRanges(i / MinMaxBricks::SIZE, j / MinMaxBricks::SIZE, Nk, ranges);
+            }
 
-    for (std::vector<int> edge_idx : recons) {
-        // edges in each individual triangle
-        OpenMesh::Vec2i edge_vert[3] = {edges[edge_idx[0]], edges[edge_idx[1]], edges[edge_idx[2]]};
+            int n_active = 0;
+            {
+                StageTimer timer(stats, ExtractionStats::CLASSIFY);
+                for (int r = 0; r < n_ranges; r++) {
+                    int k_begin = ranges[2*r], k_end = ranges[2*r + 1];
+                    const T *row = (const T *) data + grid.index(i, j, k_begin);
+                    int n = classifyRow(row, row + Nk, row + Nj*Nk, row + Nj*Nk + Nk, k_end - k_begin, isovalue,
+                                        &cases[k_begin], &active[n_active]);
+                    for (int a = n_active; a < n_active + n; a++)
+                        active[a] += k_begin;
+                    n_active += n;
+                }
+            }
+            n_active_cells += n_active;
 
-        pair<int, int> endpoints[3];
-        for (int v = 0; v < 3; v++) {
-            // current edge
-            OpenMesh::Vec2i edge = edge_vert[v];
+            StageTimer timer(stats, ExtractionStats::TRIANGULATE);
+            for (int a = 0; a < n_active; a++) {
+                int k = active[a];
+                int MC_config = cases[k];
+                const CellComponents &components = cell_components.cases[MC_config];
+                cell_points[cellSlot(i, j, k)] = slab.point_edges.size();
+                cell_cases[cellSlot(i, j, k)] = MC_config;
+                for (int c = 0; c < components.n_components; c++)
+                    addCellPoint<T>(slab, i, j, k, components.edges[c], c);
+                if (i < slab.i_begin)
+                    continue;
+                const int cell[3] = {i, j, k};
+                for (int axis = 0; axis < 3; axis++) {
+                    int u = (axis + 1) % 3, v = (axis + 2) % 3;
+                    if (cell[u] == 0 || cell[v] == 0)
+                        continue;
+                    // the edge starts at corner 0 of the cell, and ends at corner 4, 2 or 1
+                    bool above_0 = MC_config & 1, above_1 = MC_config >> (4 >> axis) & 1;
+                    if (above_0 == above_1)
+                        continue;
+
+                    // cells around the edge, counterclockwise seen from the end of the edge
+                    int c_u[3] = {i, j, k}, c_uv[3] = {i, j, k}, c_v[3] = {i, j, k};
+                    c_u[u]--;
+                    c_uv[u]--;
+                    c_uv[v]--;
+                    c_v[v]--;
+                    // the point of each cell is that of its component crossing the edge
+                    int slots[4] = {cellSlot(c_uv[0], c_uv[1], c_uv[2]), cellSlot(c_v[0], c_v[1], c_v[2]),
+                                    cellSlot(i, j, k), cellSlot(c_u[0], c_u[1], c_u[2])};
+                    int quad[4];
+                    for (int n = 0; n < 4; n++)
+                        quad[n] = cell_points[slots[n]] +
+                                  cell_components.cases[cell_cases[slots[n]]].component[quad_edges[axis][n]];
+                    // facing the higher values, like the marching cubes triangles
+                    if (above_0)
+                        std::swap(quad[1], quad[3]);
+                    uint32_t triangles[6] = {(uint32_t) quad[0], (uint32_t) quad[1], (uint32_t) quad[2],
+                                             (uint32_t) quad[0], (uint32_t) quad[2], (uint32_t) quad[3]};
+                    slab.triangles.insert(slab.triangles.end(), triangles, triangles + 6);
+                    slab.triangle_cells.insert(slab.triangle_cells.end(), 2, grid.index(i, j, k));
+                }
+            }
+        }
+    }
+    slab.stats.add(ExtractionStats::ACTIVE_CELLS, n_active_cells);
+}
+
+template <typename T>
+void Scene::extractOctree(Slab &slab) {
+    ExtractionStats *stats = collect_stats ? &slab.stats : nullptr;
+    Octree octree;
+    {
+        StageTimer timer(stats, ExtractionStats::CLASSIFY);
+        int n_threads = num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+        octree.build(data, data_type, grid, volume->bricks, isovalue, adaptive_tolerance, n_threads, cancel_flag);
+    }
+    if (cancelled())
+        return;
+
+    StageTimer timer(stats, ExtractionStats::TRIANGULATE);
+    std::vector<Octree::EdgeLeaf> quads;
+    octree.contour(quads);
+
+    // each leaf gets the points of its components when first used, as the cells of
+    // extractDualSlab (only leaves of a single cell can have more than one). A leaf around an
+    // edge twice makes its quad a triangle.
+    std::vector<int> leaf_points(octree.size(), -1);
+    size_t n_leaves = 0;
+    for (size_t q = 0; q < quads.size(); q += 4) {
+        uint32_t polygon[4];
+        int n = 0, smallest = quads[q].leaf;
+        for (int v = 0; v < 4; v++) {
+            int leaf = quads[q + v].leaf;
+            const Octree::Node &node = octree.node(leaf);
+            const CellComponents &components = cell_components.cases[node.corners];
+            if (leaf_points[leaf] < 0) {
+                leaf_points[leaf] = slab.point_edges.size();
+                for (int c = 0; c < components.n_components; c++)
+                    addCellPoint<T>(slab, node.i, node.j, node.k, components.edges[c], c, node.size);
+                n_leaves++;
+            }
+            if (node.size < octree.node(smallest).size)
+                smallest = leaf;
+            uint32_t point = leaf_points[leaf];
+            if (components.n_components > 1)
+                point += components.component[quads[q + v].edge];
+            if (n == 0 || polygon[n - 1] != point)
+                polygon[n++] = point;
+        }
+        if (polygon[n - 1] == polygon[0])
+            n--;
+
+        const Octree::Node &node = octree.node(smallest);
+        size_t cell = grid.index(node.i, node.j, node.k);
+        for (int v = 1; v + 1 < n; v++) {
+            uint32_t triangle[3] = {polygon[0], polygon[v], polygon[v + 1]};
+            slab.triangles.insert(slab.triangles.end(), triangle, triangle + 3);
+            slab.triangle_cells.push_back(cell);
+        }
+    }
+    slab.stats.add(ExtractionStats::ACTIVE_CELLS, n_leaves);
+}
+
+template <typename T>
+void Scene::extractLevelSlabs(const std::vector<float> &levels, const std::vector<char> &level_bricks,
+                              std::vector<std::vector<Slab> > &slabs) {
+    int n_slabs = slabs[0].size();
+    if (n_slabs == 1) {
+        extractSlabLevels<T>(0, levels, level_bricks, slabs);
+    } else {
+        std::vector<std::thread> workers;
+        for (int s = 0; s < n_slabs; s++)
+            workers.emplace_back(&Scene::extractSlabLevels<T>, this, s, std::cref(levels), std::cref(level_bricks),
+                                 std::ref(slabs));
+        for (std::thread &w : workers)
+            w.join();
+    }
+    // the stats of each thread are kept in its slab of the first level
+    for (const Slab &slab : slabs[0])
+        _stats.merge(slab.stats);
+}
+
+template <typename T>
+void Scene::extractSlabLevels(int s, const std::vector<float> &levels, const std::vector<char> &level_bricks,
+                              std::vector<std::vector<Slab> > &slabs) {
+    const int Nj = grid.dims[1], Nk = grid.dims[2], S = MinMaxBricks::SIZE;
+    const MinMaxBricks &bricks = volume->bricks;
+    const int i_begin = slabs[0][s].i_begin, i_end = slabs[0][s].i_end;
+
+    // number of levels below each sample of two consecutive planes. A sample is above the
+    // levels lower than its rank, so a cell is crossed by the levels from the lowest rank of its
+    // corners up to (excluding) the highest one, and each sample is read only once.
+    std::vector<int> ranks(2*Nj*Nk);
+    auto rankPlane = [&](int i) {
+        const T *plane = (const T *) data + grid.index(i, 0, 0);
+        int *plane_ranks = &ranks[(i & 1)*Nj*Nk];
+        for (int v = 0; v < Nj*Nk; v++)
+            plane_ranks[v] = std::lower_bound(levels.begin(), levels.end(), toFloat(plane[v])) - levels.begin();
+    };
+    auto rank = [&](int i, int j, int k) {return ranks[((i & 1)*Nj + j)*Nk + k];};
+
+    // each edge of the two planes of the edge index has a list in the plane of its first
+    // sample, with the lowest level crossing it and then the point index for each level
+    EdgeIndex edge_index(Nj, Nk);
+    std::vector<int> edge_levels[2];
+    ExtractionStats *stats = collect_stats ? &slabs[0][s].stats : nullptr;
+    size_t n_active_cells = 0;
+    {
+        StageTimer timer(stats, ExtractionStats::CLASSIFY);
+        rankPlane(i_begin);
+    }
+    for (int i = i_begin; i < i_end && !cancelled(); i++) {
+        edge_index.clearPlane(i + 1);
+        edge_levels[(i + 1) & 1].clear();
+        {
+            StageTimer timer(stats, ExtractionStats::CLASSIFY);
+            rankPlane(i + 1);
+        }
+        // the cases follow from the ranks, so finding them is part of the triangulation
+        StageTimer timer(stats, ExtractionStats::TRIANGULATE);
+        for (int j = 0; j < Nj - 1; j++) {
+            for (int bk = 0; bk < bricks.size(2); bk++) {
+                int brick = bricks.index(i / S, j / S, bk);
+                if (!level_bricks[brick])
+                    continue;
+
+                for (int k = bk * S; k < std::min((bk + 1) * S, Nk - 1); k++) {
+                    int corners[8], lowest = INT_MAX, highest = 0;
+                    for (int c = 0; c < 8; c++) {
+                        corners[c] = rank(i + MC_CORNERS[c][0], j + MC_CORNERS[c][1], k + MC_CORNERS[c][2]);
+                        lowest = std::min(lowest, corners[c]);
+                        highest = std::max(highest, corners[c]);
+                    }
+                    n_active_cells += highest - lowest;
+
+                    for (int l = lowest; l < highest; l++) {
+                        int MC_config = 0;
+                        for (int c = 0; c < 8; c++)
+                            MC_config |= (corners[c] > l) << c;
+
+                        const MCcase &recons = MC_CASES[MC_config];
+                        Slab &slab = slabs[l][s];
+                        for (int t = 0; t < recons.n_triangles; t++) {
+                            for (int v = 0; v < 3; v++) {
+                                int origin[3], axis;
+                                cellEdge(recons.edges[3*t + v], origin, axis);
+                                int e[3] = {i + origin[0], j + origin[1], k + origin[2]};
+                                std::vector<int> &lists = edge_levels[e[0] & 1];
+                                int &list = edge_index(e[0], e[1], e[2], axis);
+                                if (list < 0) {
+                                    int r0 = rank(e[0], e[1], e[2]);
+                                    int r1 = rank(e[0] + (axis == 0), e[1] + (axis == 1), e[2] + (axis == 2));
+                                    list = lists.size();
+                                    lists.push_back(std::min(r0, r1));
+                                    lists.resize(lists.size() + std::abs(r1 - r0), -1);
+                                }
+
+                                int &vtx_idx = lists[list + 1 + l - lists[list]];
+                                if (vtx_idx < 0)
+                                    vtx_idx = addPoint<T>(slab, e[0], e[1], e[2], axis, levels[l]);
+                                slab.triangles.push_back(vtx_idx);
+                            }
+                            slab.triangle_cells.push_back(grid.index(i, j, k));
+                        }
+                    }
+                }
+            }
+        }
+    }
+    size_t n_lookups = 0;
+    for (std::vector<Slab> &level_slabs : slabs)
+        n_lookups += level_slabs[s].triangles.size();
+    slabs[0][s].stats.add(ExtractionStats::ACTIVE_CELLS, n_active_cells);
+    slabs[0][s].stats.add(ExtractionStats::EDGE_LOOKUPS, n_lookups);
+}
 
-            // get edge endpoints
-            glm::vec3 endpoint_0_indices = {i + verts[edge[0]][0], j + verts[edge[0]][1], k + verts[edge[0]][2]};
-            glm::vec3 endpoint_1_indices = {i + verts[edge[1]][0], j + verts[edge[1]][1], k + verts[edge[1]][2]};
+bool Scene::parseVolume(const char* name, bool preview) {
+    // only loaded the first time, or if the file changed since
+    if (!initializeData(name, preview)) return false;
+    if (std::find(_volume_names.begin(), _volume_names.end(), name) == _volume_names.end())
+        _volume_names.push_back(std::string(name));
 
+    return true;
+}
 
-            // edge endpoints in 1D (flattened)
-            int p0_idx_1D = endpoint_0_indices.x * N * N + endpoint_0_indices.y * N + endpoint_0_indices.z;
-            int p1_idx_1D = endpoint_1_indices.x * N * N + endpoint_1_indices.y * N + endpoint_1_indices.z;
+template <typename T>
+const MCresolvedCase &Scene::resolvedCase(int MC_config, int i, int j, int k) const {
+    // samples of the corners relative to the isovalue, so that both cells of a face decide it
+    // from the same values
+    const T *samples = (const T *) data;
+    float corners[8];
+    for (int c = 0; c < 8; c++)
+        corners[c] = toFloat(samples[grid.index(i + MC_CORNERS[c][0], j + MC_CORNERS[c][1], k + MC_CORNERS[c][2])]) -
+                     isovalue;
+
+    int ambiguous = mcAmbiguousFaces(MC_config), joined = 0, n = 0;
+    for (int f = 0; f < 6; f++) {
+        if (!(ambiguous >> f & 1))
+            continue;
+        const int *c = MC_FACES[f];
+        joined |= mcJoinedAcross(corners[c[0]], corners[c[1]], corners[c[2]], corners[c[3]]) << n++;
+    }
+    return mcResolvedCase(MC_config, joined);
+}
+
+template <typename T>
+void Scene::reconstructVoxel(int n_triangles, const unsigned char *triangle_edges, Slab &slab, EdgeIndex &edge_index,
+                             int &i, int &j, int &k, int center_edges) {
+    size_t cell = grid.index(i, j, k);
+    int center = -1;
+
+    for (int t = 0; t < n_triangles; t++) {
+        int triangle[3];
+        for (int v = 0; v < 3; v++) {
+            if (triangle_edges[3*t + v] == MC_CELL_CENTER) {
+                if (center < 0)
+                    center = addCenterPoint<T>(slab, i, j, k, center_edges);
+                triangle[v] = center;
+                continue;
+            }
 
-            // define endpoints pair
-            endpoints[v] = std::make_pair(p0_idx_1D, p1_idx_1D);
+            // edges are indexed by the sample they start at (lowest endpoint) and their axis
+            int origin[3], axis;
+            cellEdge(triangle_edges[3*t + v], origin, axis);
+            int &vtx_idx = edge_index(i + origin[0], j + origin[1], k + origin[2], axis);
 
             // if endpoint vertex is already defined, do not create it again
-            if (edge_to_vtx_dict.find(endpoints[v]) == edge_to_vtx_dict.end()) {
-                // get value stored in edge endpoints
-                float end_point_0 = data[(int)endpoint_0_indices[0]*N*N + (int)endpoint_0_indices[1]*N + (int)endpoint_0_indices[2]];
-                float end_point_1 = data[(int)endpoint_1_indices[0]*N*N + (int)endpoint_1_indices[1]*N + (int)endpoint_1_indices[2]];
+            if (vtx_idx < 0) {
+                // add point index to edge index
+                vtx_idx = addPoint<T>(slab, i + origin[0], j + origin[1], k + origin[2], axis, isovalue);
+            }
+            triangle[v] = vtx_idx;
+        }
+
+        // add triangle to slab
+        slab.triangles.insert(slab.triangles.end(), triangle, triangle + 3);
+        slab.triangle_cells.push_back(cell);
+    }
+}
+
+void Scene::cellEdge(int edge, int origin[3], int &axis) {
+    const int *vert_0 = MC_CORNERS[MC_EDGES[edge][0]], *vert_1 = MC_CORNERS[MC_EDGES[edge][1]];
+    axis = vert_0[0] != vert_1[0] ? 0 : vert_0[1] != vert_1[1] ? 1 : 2;
+    for (int c = 0; c < 3; c++)
+        origin[c] = std::min(vert_0[c], vert_1[c]);
+}
+
+template <typename T>
+void Scene::edgePoint(int i, int j, int k, int axis, float iso, float *point, float *normal, int length) const {
+    // get edge endpoints, lowest first so that the point does not depend on the cell it is created for
+    int i_1 = i + length*(axis == 0), j_1 = j + length*(axis == 1), k_1 = k + length*(axis == 2);
+    glm::vec3 endpoint_0_indices = {i, j, k};
+    glm::vec3 endpoint_1_indices = {i_1, j_1, k_1};
 
-                // get vertex position using linear interpolation with the threshold value
-                float alpha = (isovalue - end_point_0) / (end_point_1 - end_point_0);
-                glm::vec3 vtx = glm::mix(endpoint_0_indices * cell_size, endpoint_1_indices * cell_size, alpha);
+    // get value stored in edge endpoints, the only samples converted to float
+    const T *samples = (const T *) data;
+    float end_point_0 = toFloat(samples[grid.index(i, j, k)]);
+    float end_point_1 = toFloat(samples[grid.index(i_1, j_1, k_1)]);
 
-                // add vertex handler to dictionary
-                edge_to_vtx_dict[endpoints[v]] = m.add_vertex(MyMesh::Point(vtx.x, vtx.y, vtx.z));
+    // get vertex position using linear interpolation with the threshold value
+    float alpha = (iso - end_point_0) / (end_point_1 - end_point_0);
+    glm::vec3 vtx = glm::make_vec3(grid.origin) + glm::mix(endpoint_0_indices * glm::make_vec3(grid.spacing),
+                                                           endpoint_1_indices * glm::make_vec3(grid.spacing), alpha);
+    std::copy(&vtx.x, &vtx.x + 3, point);
+
+    if (normal) {
+        // the gradient points towards higher values, away from the inside of the surface
+        glm::vec3 n = glm::mix(gradient<T>(i, j, k), gradient<T>(i_1, j_1, k_1), alpha);
+        // flat around the vertex: the edge, from its lower to its higher endpoint
+        if (n == glm::vec3(0.f))
+            n = (end_point_1 > end_point_0 ? 1.f : -1.f) * (endpoint_1_indices - endpoint_0_indices);
+        n = glm::normalize(n);
+        std::copy(&n.x, &n.x + 3, normal);
+    }
+}
+
+// point minimizing the sum of the squared distances to the planes through the given points with
+// the given normals. Along flat or creased parts of the surface there is a line or plane of
+// them, so the one closest to center is taken, and the directions in which the planes barely
+// constrain the point (small eigenvalues of the normal equations) are left at center.
+static glm::vec3 minimizeQEF(const glm::vec3 *points, const glm::vec3 *normals, int n, glm::vec3 center) {
+    glm::mat3 a(0.f);
+    glm::vec3 b(0.f);
+    for (int p = 0; p < n; p++) {
+        a += glm::outerProduct(normals[p], normals[p]);
+        b += normals[p] * glm::dot(normals[p], points[p] - center);
+    }
+
+    // eigenvectors of a (the columns of v) by Jacobi rotations, leaving its eigenvalues on the diagonal
+    glm::mat3 v(1.f);
+    for (int sweep = 0; sweep < 8; sweep++) {
+        for (int p = 0; p < 2; p++) {
+            for (int q = p + 1; q < 3; q++) {
+                if (std::abs(a[p][q]) < 1e-12f)
+                    continue;
+                float theta = (a[q][q] - a[p][p]) / (2.f * a[p][q]);
+                float t = (theta >= 0.f ? 1.f : -1.f) / (std::abs(theta) + std::sqrt(theta * theta + 1.f));
+                float c = 1.f / std::sqrt(t * t + 1.f), s = t * c;
+                glm::mat3 rotation(1.f);
+                rotation[p][p] = rotation[q][q] = c;
+                rotation[q][p] = s;
+                rotation[p][q] = -s;
+                a = glm::transpose(rotation) * a * rotation;
+                v = v * rotation;
             }
         }
+    }
+
+    float max_eigenvalue = std::max({a[0][0], a[1][1], a[2][2]});
+    glm::vec3 x = center;
+    for (int e = 0; e < 3; e++)
+        if (a[e][e] > 0.1f * max_eigenvalue)
+            x += v[e] * (glm::dot(v[e], b) / a[e][e]);
+    return x;
+}
+
+template <typename T>
+uint32_t Scene::addCellPoint(Slab &slab, int i, int j, int k, int edges, int component, int size) const {
+    // crossings of the surface on the edges of the cell, with its normal there if needed
+    bool dual_contouring = extraction_method == DUAL_CONTOURING || extraction_method == ADAPTIVE_DUAL_CONTOURING;
+    bool normals = dual_contouring || normal_mode == GRADIENT_NORMALS;
+    glm::vec3 crossings[12], crossing_normals[12];
+    glm::vec3 center(0.f), normal(0.f);
+    int n = 0;
+    for (int e = 0; e < 12; e++) {
+        if (edges >> e & 1) {
+            int origin[3], axis;
+            cellEdge(e, origin, axis);
+            edgePoint<T>(i + origin[0]*size, j + origin[1]*size, k + origin[2]*size, axis, isovalue, &crossings[n].x,
+                         normals ? &crossing_normals[n].x : nullptr, size);
+            center += crossings[n];
+            if (normals)
+                normal += crossing_normals[n];
+            n++;
+        }
+    }
+    center /= float(n);
+
+    glm::vec3 point = center;
+    if (dual_contouring) {
+        // kept in the cell, so that the quads do not fold over their neighbours
+        glm::vec3 cell_min = glm::make_vec3(grid.origin) + glm::vec3(i, j, k) * glm::make_vec3(grid.spacing);
+        point = glm::clamp(minimizeQEF(crossings, crossing_normals, n, center), cell_min,
+                           cell_min + float(size) * glm::make_vec3(grid.spacing));
+    }
+
+    slab.points.insert(slab.points.end(), &point.x, &point.x + 3);
+    if (normal_mode == GRADIENT_NORMALS) {
+        if (normal != glm::vec3(0.f))
+            normal = glm::normalize(normal);
+        slab.normals.insert(slab.normals.end(), &normal.x, &normal.x + 3);
+    }
+    slab.point_edges.push_back((long long) grid.index(i + 1, j, k)*4 + component);
+    return slab.point_edges.size() - 1;
+}
+
+template <typename T>
+uint32_t Scene::addCenterPoint(Slab &slab, int i, int j, int k, int center_edges) const {
+    // average of the crossings of the given edges, only used by its own cell
+    glm::vec3 center(0.f), normal(0.f);
+    for (int e = 0; e < 12; e++) {
+        if (center_edges >> e & 1) {
+            int origin[3], axis;
+            glm::vec3 crossing, crossing_normal;
+            cellEdge(e, origin, axis);
+            edgePoint<T>(i + origin[0], j + origin[1], k + origin[2], axis, isovalue, &crossing.x,
+                         normal_mode == GRADIENT_NORMALS ? &crossing_normal.x : nullptr);
+            center += crossing;
+            if (normal_mode == GRADIENT_NORMALS)
+                normal += crossing_normal;
+        }
+    }
+    center /= float(__builtin_popcount(center_edges));
+
+    slab.points.insert(slab.points.end(), &center.x, &center.x + 3);
+    if (normal_mode == GRADIENT_NORMALS) {
+        if (normal != glm::vec3(0.f))
+            normal = glm::normalize(normal);
+        slab.normals.insert(slab.normals.end(), &normal.x, &normal.x + 3);
+    }
+    slab.point_edges.push_back((long long) grid.n_samples()*3 + grid.index(i, j, k));
+    return slab.point_edges.size() - 1;
+}
+
+template <typename T>
+uint32_t Scene::addPoint(Slab &slab, int i, int j, int k, int axis, float iso) const {
+    float point[3], normal[3];
+    edgePoint<T>(i, j, k, axis, iso, point, normal_mode == GRADIENT_NORMALS ? normal : nullptr);
+
+    slab.points.insert(slab.points.end(), point, point + 3);
+    if (normal_mode == GRADIENT_NORMALS)
+        slab.normals.insert(slab.normals.end(), normal, normal + 3);
+    slab.point_edges.push_back((long long) grid.index(i, j, k)*3 + axis);
+    return slab.point_edges.size() - 1;
+}
 
-        // add face to mesh
-        std::vector<MyMesh::VertexHandle> face_vhandles;
-        MyMesh::FaceHandle face;
-        face_vhandles.clear();
-        face_vhandles.push_back(edge_to_vtx_dict[endpoints[0]]);
-        face_vhandles.push_back(edge_to_vtx_dict[endpoints[1]]);
-        face_vhandles.push_back(edge_to_vtx_dict[endpoints[2]]);
-        face = m.add_face(face_vhandles);
-        m.set_color(face, MyMesh::Color(0.6, 0.6, 0.6));
+template <typename T>
+glm::vec3 Scene::gradient(int i, int j, int k) const {
+    // central differences, one-sided on the boundary of the volume
+    const T *sample = (const T *) data + grid.index(i, j, k);
+    const int coords[3] = {i, j, k};
+    const size_t strides[3] = {(size_t) grid.dims[1] * grid.dims[2], (size_t) grid.dims[2], 1};
+    glm::vec3 g;
+    for (int axis = 0; axis < 3; axis++) {
+        int lo = coords[axis] > 0 ? 1 : 0, hi = coords[axis] < grid.dims[axis] - 1 ? 1 : 0;
+        float f_lo = toFloat(*(sample - lo * strides[axis]));
+        float f_hi = toFloat(*(sample + hi * strides[axis]));
+        g[axis] = (f_hi - f_lo) / ((lo + hi) * grid.spacing[axis]);
     }
+    return g;
 }
 
 void Scene::addCube() {
@@ -504,24 +1573,38 @@ void Scene::setIsovalue(float val) {
     std::cout << "New isovalue: " << val << std::endl;
 }
 
-void Scene::initializeData(std::ifstream &volume_file, int N)
-{
-    if (data)
-        delete data;
+void Scene::setNumThreads(int n) {
+    num_threads = std::max(0, n);
+}
 
-    _min_value = INFINITY;
-    _max_value = -INFINITY;
+Scene::Settings Scene::settings() const {
+    return Settings{num_threads, output_mode, normal_mode, extraction_method, adaptive_tolerance,
+                    incremental_updates, collect_stats};
+}
 
-    data = new float[N*N*N];
+void Scene::setSettings(const Settings &settings) {
+    num_threads = settings.num_threads;
+    output_mode = settings.output_mode;
+    normal_mode = settings.normal_mode;
+    extraction_method = settings.extraction_method;
+    adaptive_tolerance = settings.adaptive_tolerance;
+    incremental_updates = settings.incremental_updates;
+    collect_stats = settings.collect_stats;
+}
 
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-            for (int k = 0; k < N; k++) {
-                volume_file >> data[i*N*N + j*N + k];
+bool Scene::initializeData(const char *name, bool preview)
+{
+    // volumes are loaded once, along with the value range of their bricks
+    StageTimer timer(collectedStats(), ExtractionStats::LOAD);
+    std::shared_ptr<const LoadedVolume> loaded = volume_cache->acquire(name, num_threads, preview);
+    _volume_loaded = loaded != nullptr;
+    if (!loaded) return false;
 
-                _min_value = min(_min_value, data[i*N*N + j*N + k]);
-                _max_value = max(_max_value, data[i*N*N + j*N + k]);
-            }
-        }
-    }
+    volume = loaded;
+    grid = volume->grid;
+    data = volume->data;
+    data_type = volume->type;
+    _min_value = volume->min_value;
+    _max_value = volume->max_value;
+    return true;
 }
@@ -21,10 +21,17 @@
 #define __MeshViewer_scene_h_
 #include <vector>
 #include <utility>
-#include <unordered_map>
+#include <cstdint>
+#include <atomic>
+#include <memory>
 #include <OpenMesh/Core/IO/MeshIO.hh>
 #include <OpenMesh/Core/Mesh/TriMesh_ArrayKernelT.hh>
 #include "utils.h"
+#include "grid.h"
+#include "volumecache.h"
+#include "stats.h"
+#include "decider.h"
+#include "octree.h"
 #include "taulaMC.hpp"
 
 #define OUT
@@ -47,39 +54,300 @@ struct MyTraits : public OpenMesh::DefaultTraits
 };
 typedef OpenMesh::TriMesh_ArrayKernelT<MyTraits>  MyMesh;
 
+// vertex of an isosurface as it is uploaded to the GL buffers: position, normal and color (as
+// normalized bytes). 32 bytes, so that every vertex starts 16 byte aligned.
+struct alignas(16) InterleavedVertex {
+  float position[3];
+  float normal[3];
+  uint8_t color[4];
+};
+
+// triangle mesh stored as flat arrays, as produced by the extraction
+struct IsoSurface {
+  std::vector<float> positions;  // x, y, z per vertex
+  std::vector<float> normals;    // x, y, z per vertex
+  std::vector<uint32_t> indices; // 3 vertex indices per triangle
+  // the vertices packed in a single buffer instead of positions and normals (INTERLEAVED_BUFFERS)
+  std::vector<InterleavedVertex> vertices;
+  size_t n_vertices() const {return vertices.empty() ? positions.size() / 3 : vertices.size();}
+  size_t n_triangles() const {return indices.size() / 3;}
+};
+
 class Scene {
  public:
   Scene();
   ~Scene();
   bool load(const char* name);
   int loadVolume(const char* name);
-  bool computeVolumeIsosurface(const char* name);
+  // with preview, the isosurface is extracted from the volume downsampled
+  // LoadedVolume::PREVIEW_FACTOR times along each axis: a coarse surface, but quickly
+  bool computeVolumeIsosurface(const char* name, bool preview = false);
+  // one isosurface per isovalue, all extracted in a single pass over the volume. They are
+  // appended in the order of the isovalues, empty ones included.
+  bool computeVolumeIsosurfaces(const char* name, const std::vector<float> &isovalues);
   void addCube();
   void addCubeVertexcolors();
   void addOctahedron(OpenMesh::Vec3d position, float scale);
 
   void setIsovalue(float val);
+  // number of worker threads used for extraction (0 = one per hardware thread)
+  void setNumThreads(int n);
+  int numThreads() const {return num_threads;}
+  // volumes loaded before are reused from the cache, without reading their file again
+  VolumeCache &volumeCache() {return *volume_cache;}
+  // uses the cache of another scene, so that both load each volume once (the cache may be used
+  // from several threads)
+  void shareVolumeCache(const Scene &other) {volume_cache = other.volume_cache;}
+
+  // isosurfaces are either converted to an OpenMesh mesh (appended to meshes()) or kept as
+  // the flat arrays filled by the extraction (appended to surfaces()). INTERLEAVED_BUFFERS packs
+  // those arrays into the vertices of the surface, to upload them to the GL buffers as they are.
+  typedef enum {HALFEDGE_MESH=0, FLAT_BUFFERS, INTERLEAVED_BUFFERS} OutputMode;
+  void setOutputMode(OutputMode mode) {output_mode = mode;}
+  OutputMode outputMode() const {return output_mode;}
+  static void buildMesh(const IsoSurface &surface, MyMesh &m, bool vertex_normals = false,
+                        ExtractionStats *stats = nullptr);
+
+  // vertex normals are either averaged from the triangles around each vertex once the surface
+  // is extracted, or interpolated from the gradient of the volume as each vertex is created.
+  // With NO_NORMALS, flat buffers are left without normals.
+  typedef enum {FACE_NORMALS=0, GRADIENT_NORMALS, NO_NORMALS} NormalMode;
+  void setNormalMode(NormalMode mode) {normal_mode = mode;}
+  NormalMode normalMode() const {return normal_mode;}
+  // area weighted average of the normals of the triangles around each vertex (FACE_NORMALS)
+  static void computeNormals(IsoSurface &surface);
+  // packs the positions and normals of the surface into its vertices, and releases them
+  // (INTERLEAVED_BUFFERS)
+  void interleaveVertices(IsoSurface &surface) const;
+
+  // marching cubes, or a dual method: one vertex for each sheet of the surface in a cell crossed
+  // by it, and a quad joining those of the four cells around each crossed edge. The vertex is
+  // either the average of the crossings on the edges of the sheet (SURFACE_NETS), or the point
+  // closest to the planes tangent to the surface at them (DUAL_CONTOURING), which keeps sharp
+  // edges and corners. Dual surfaces have about as many vertices as marching cubes ones, but no
+  // sliver triangles. They are manifold where the marching cubes surface is closed, but not
+  // always across the ambiguous faces that two cells decide differently (its cracks). They end
+  // half a cell inside the border of the volume, and lose what only crosses the border cells.
+  // ASYMPTOTIC_DECIDER is marching cubes with the ambiguous faces of the cells resolved as in the
+  // trilinear interpolation of the samples (see decider.h), instead of the same way for every
+  // cell of a case. ADAPTIVE_DUAL_CONTOURING places the vertices of dual contouring in the
+  // leaves of an octree (see octree.h), as large as the surface is well approximated in them, so
+  // flat parts of the surface get fewer and larger triangles.
+  typedef enum {MARCHING_CUBES=0, SURFACE_NETS, DUAL_CONTOURING, ASYMPTOTIC_DECIDER,
+                ADAPTIVE_DUAL_CONTOURING} ExtractionMethod;
+  void setExtractionMethod(ExtractionMethod method) {extraction_method = method;}
+  ExtractionMethod extractionMethod() const {return extraction_method;}
+  // largest distance, in voxels, by which the surface in an octree leaf may move from that of
+  // the samples it covers (ADAPTIVE_DUAL_CONTOURING, 0.1 by default)
+  void setAdaptiveTolerance(float voxels) {adaptive_tolerance = voxels;}
+  float adaptiveTolerance() const {return adaptive_tolerance;}
+
+  // when only the isovalue changes, the last isosurface is updated instead of extracted again
+  // (enabled by default)
+  void setIncrementalUpdates(bool enabled) {incremental_updates = enabled;}
+
+  // the extraction stops as soon as the flag is set (it is checked by the worker threads at
+  // each plane of cells), and computeVolumeIsosurface then returns false. Null to never stop.
+  void setCancelFlag(const std::atomic<bool> *flag) {cancel_flag = flag;}
+  bool cancelled() const {return cancel_flag && cancel_flag->load(std::memory_order_relaxed);}
+
+  // how isosurfaces are extracted, to extract them the same way in another scene
+  struct Settings {
+    int num_threads;
+    OutputMode output_mode;
+    NormalMode normal_mode;
+    ExtractionMethod extraction_method;
+    float adaptive_tolerance;
+    bool incremental_updates;
+    bool collect_stats;
+  };
+  Settings settings() const;
+  void setSettings(const Settings &settings);
+
+  // time spent in each stage of the last extraction and the work it did, cleared when the next
+  // one starts. They are only collected when enabled, since the clock is read for every row.
+  void setCollectStats(bool enabled) {collect_stats = enabled;}
+  bool collectsStats() const {return collect_stats;}
+  const ExtractionStats &stats() const {return _stats;}
+  // where the stages run outside the scene (such as the upload to the GL buffers) add their
+  // time, or null if stats are not collected
+  ExtractionStats *collectedStats() {return collect_stats ? &_stats : nullptr;}
 
   typedef enum {NONE=0, VERTEX_COLORS, FACE_COLORS} ColorInfo;
   const std::vector<std::pair<MyMesh,ColorInfo> >& meshes() {return _meshes;}
+  const std::vector<IsoSurface>& surfaces() {return _surfaces;}
   const std::vector<std::string>& volume_names() {return _volume_names;}
-  void clear_meshes() {_meshes.clear();}
+  void clear_meshes() {_meshes.clear(); _surfaces.clear();}
+  // moves the meshes and surfaces out of the scene, to hand them to another thread
+  void take_meshes(std::vector<std::pair<MyMesh,ColorInfo> > &meshes, std::vector<IsoSurface> &surfaces) {
+    meshes.swap(_meshes); _meshes.clear();
+    surfaces.swap(_surfaces); _surfaces.clear();
+  }
   float min_value() {return _min_value;}
   float max_value() {return _max_value;}
+  // whether the volume of the last isosurface computed (or loadVolume) could be loaded, even if
+  // it had no surface at the isovalue. The value range is that of the last volume loaded.
+  bool volume_loaded() const {return _volume_loaded;}
 
  private:
   std::vector<std::pair<MyMesh,ColorInfo> > _meshes;
+  std::vector<IsoSurface> _surfaces;
   std::vector<std::string> _volume_names;
-  float* data;
-  float _min_value, _max_value, cell_size, isovalue, thr;
-  MCcases cases;
+  bool _volume_loaded;
+  std::shared_ptr<VolumeCache> volume_cache;
+  std::shared_ptr<const LoadedVolume> volume; // current volume, pinned in the cache
+  const void* data;                           // its samples, of type data_type
+  VolumeType data_type;
+  Grid grid;
+  ActiveBricks active_bricks;
+  float _min_value, _max_value, isovalue, thr;
+  int num_threads;
+  OutputMode output_mode;
+  NormalMode normal_mode;
+  ExtractionMethod extraction_method;
+  float adaptive_tolerance;
+  bool incremental_updates;
+  bool collect_stats;
+  const std::atomic<bool> *cancel_flag;
+  ExtractionStats _stats;
+
+  // output of the extraction of one slab of cells along the i axis
+  struct Slab {
+    int i_begin, i_end;
+    std::vector<float> points;          // x, y, z per point
+    std::vector<float> normals;         // x, y, z per point, with GRADIENT_NORMALS
+    std::vector<long long> point_edges; // edge on which each point lies, as grid.index(i, j, k)*3 + axis
+                                        // (for dual methods, component c of cell (i, j, k) of the
+                                        // point as grid.index(i + 1, j, k)*4 + c, on the plane of
+                                        // samples where the cell ends like the edges shared with
+                                        // the next slab;
+                                        // for a cell center, grid.n_samples()*3 + grid.index(i, j, k),
+                                        // past the last plane so that it is never shared)
+    std::vector<uint32_t> triangles;    // 3 local point indices per triangle
+    std::vector<size_t> triangle_cells; // cell of each triangle, as grid.index(i, j, k)
+    ExtractionStats stats;              // of the thread extracting the slab, merged when it ends
+  };
+
+  // edges and triangles of the last extracted isosurface, kept to update it when only the
+  // isovalue changes
+  struct LastSurface {
+    std::weak_ptr<const LoadedVolume> volume;
+    float isovalue;
+    std::vector<long long> vertex_edges; // edge on which each vertex lies, as grid.index(i, j, k)*3 + axis
+    std::vector<uint32_t> indices;       // 3 vertex indices per triangle
+    std::vector<size_t> triangle_cells;  // cell of each triangle, as grid.index(i, j, k)
+    int n_bricks;                        // bricks with some triangle
+  } last_surface;
+
+  // point index of the edges starting at each sample (one per axis) of two consecutive
+  // planes, so edges are found with a single lookup and only O(Nj*Nk) of them are kept
+  struct EdgeIndex {
+    int Nj, Nk;
+    std::vector<int> vertex_ids;
+    EdgeIndex(int Nj, int Nk) : Nj(Nj), Nk(Nk), vertex_ids(2*Nj*Nk*3, -1) {}
+    void clearPlane(int i) {
+      std::fill(vertex_ids.begin() + (i & 1)*Nj*Nk*3, vertex_ids.begin() + ((i & 1) + 1)*Nj*Nk*3, -1);
+    }
+    int &operator()(int i, int j, int k, int axis) {return vertex_ids[(((i & 1)*Nj + j)*Nk + k)*3 + axis];}
+  };
 
-  // set of edges and vertices indices (in order according to taulaMC.hpp)
-  std::vector<OpenMesh::Vec2i> edges = {{0, 4}, {4, 5}, {5, 1}, {1, 0}, {2, 6}, {6, 7}, {7, 3}, {3, 2}, {4, 6}, {5, 7}, {0, 2}, {1, 3}};
-  std::vector<OpenMesh::Vec3i> verts = {{0, 0, 0}, {0, 0, 1}, {0, 1, 0}, {0, 1, 1}, {1, 0, 0}, {1, 0, 1}, {1, 1, 0}, {1, 1, 1}};
+  // point index of a sparse set of edges, in an open addressing hash table
+  struct EdgeMap {
+    std::vector<long long> edges; // -1 for empty slots
+    std::vector<uint32_t> ids;
+    size_t n_edges;
+    size_t n_probes;              // slots visited by insert
+    EdgeMap() : edges(1024, -1), ids(1024), n_edges(0), n_probes(0) {}
+    // index of the edge, set to id if the edge was not in the map. Returns whether it was added.
+    bool insert(long long edge, uint32_t &id) {
+      if (2*(n_edges + 1) > edges.size()) grow();
+      size_t slot = hash(edge) & (edges.size() - 1);
+      n_probes++;
+      while (edges[slot] >= 0) {
+        if (edges[slot] == edge) {id = ids[slot]; return false;}
+        slot = (slot + 1) & (edges.size() - 1);
+        n_probes++;
+      }
+      edges[slot] = edge;
+      ids[slot] = id;
+      n_edges++;
+      return true;
+    }
+    size_t size() const {return n_edges;}
+    void reserve(size_t n) {
+      while (edges.size() < 2*n) grow();
+    }
+    static size_t hash(long long edge) {return (uint64_t) edge * 0x9E3779B97F4A7C15ULL >> 20;}
+    void grow() {
+      std::vector<long long> old_edges(2*edges.size(), -1);
+      std::vector<uint32_t> old_ids(2*edges.size());
+      old_edges.swap(edges);
+      old_ids.swap(ids);
+      n_edges = 0;
+      for (size_t s = 0; s < old_edges.size(); s++)
+        if (old_edges[s] >= 0) insert(old_edges[s], old_ids[s]);
+    }
+  };
 
-  void initializeData(std::ifstream &volume_file, int N);
-  bool parseVolume(const char* name, std::ifstream &volume_file, int &N);
-  void reconstructVoxel(int &MC_config, int &N, MyMesh &m, std::unordered_map<std::pair<int, int>, MyMesh::VertexHandle, hash_pair> &edge_to_vtx_dict, int &i, int &j, int &k);
+  bool initializeData(const char *name, bool preview = false);
+  bool parseVolume(const char* name, bool preview = false);
+  bool extractIsosurface(IsoSurface &surface);
+  void extractAllBricks(IsoSurface &surface);
+  // surfaces of the isovalues, sorted in increasing order
+  void extractLevels(const std::vector<float> &levels, std::vector<IsoSurface> &surfaces);
+  // joins the slabs of a surface, and lists the edge of each vertex and brick of each triangle
+  void stitchSlabs(const std::vector<Slab> &slabs, IsoSurface &surface, std::vector<long long> &vertex_edges,
+                   std::vector<size_t> &triangle_cells) const;
+  template <typename T>
+  bool updateChangedBricks(IsoSurface &surface);
+  template <typename T>
+  void moveVertices(const std::vector<long long> &vertex_edges, IsoSurface &surface);
+  // sample at which the edge grid.index(i, j, k)*3 + axis starts, and its axis
+  void decodeEdge(long long edge, int sample[3], int &axis) const;
+  // brick of a cell given as grid.index(i, j, k)
+  int cellBrick(size_t cell) const;
+  template <typename T>
+  void extractSlabs(std::vector<Slab> &slabs);
+  template <typename T>
+  void extractSlab(Slab &slab);
+  template <typename T>
+  void extractDualSlab(Slab &slab);
+  // extracts the whole volume as a single slab (ADAPTIVE_DUAL_CONTOURING)
+  template <typename T>
+  void extractOctree(Slab &slab);
+  template <typename T>
+  void extractLevelSlabs(const std::vector<float> &levels, const std::vector<char> &level_bricks,
+                         std::vector<std::vector<Slab> > &slabs);
+  // the slab s of every level, with the bricks that contain some of them
+  template <typename T>
+  void extractSlabLevels(int s, const std::vector<float> &levels, const std::vector<char> &level_bricks,
+                         std::vector<std::vector<Slab> > &slabs);
+  template <typename T>
+  glm::vec3 gradient(int i, int j, int k) const;
+  // sample at which an edge of the cube starts (its lowest corner) and its axis
+  static void cellEdge(int edge, int origin[3], int &axis);
+  // point where the surface crosses the edge starting at sample (i, j, k) along axis, and its
+  // normal if requested (GRADIENT_NORMALS)
+  template <typename T>
+  void edgePoint(int i, int j, int k, int axis, float iso, float *point, float *normal, int length = 1) const;
+  // adds that point to the slab, and returns its index
+  template <typename T>
+  uint32_t addPoint(Slab &slab, int i, int j, int k, int axis, float iso) const;
+  // adds the vertex of a component of the surface in a cell (dual methods), placed from its
+  // crossed edges (bit e set for cube edge e), and returns its index. The cell may span size
+  // cells along each axis (an octree leaf).
+  template <typename T>
+  uint32_t addCellPoint(Slab &slab, int i, int j, int k, int edges, int component, int size = 1) const;
+  // triangles of a cell with ambiguous faces, decided from its samples (ASYMPTOTIC_DECIDER)
+  template <typename T>
+  const MCresolvedCase &resolvedCase(int MC_config, int i, int j, int k) const;
+  // adds the vertex MC_CELL_CENTER of cell (i, j, k), and returns its index
+  template <typename T>
+  uint32_t addCenterPoint(Slab &slab, int i, int j, int k, int center_edges) const;
+  // adds the triangles of a cell, given as triplets of the cube edges where their vertices lie
+  // (or MC_CELL_CENTER, placed with center_edges)
+  template <typename T>
+  void reconstructVoxel(int n_triangles, const unsigned char *triangle_edges, Slab &slab, EdgeIndex &edge_index,
+                        int &i, int &j, int &k, int center_edges = 0);
 };
 #endif // __MeshViewer_scene_h_
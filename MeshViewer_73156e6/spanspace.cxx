@@ -0,0 +1,142 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#include "spanspace.h"
+
+#include <algorithm>
+
+int ActiveBricks::cellRanges(int bi, int bj, int Nk, std::vector<int> &ranges) const {
+    int r = bi*n_bricks[1] + bj;
+    int n_ranges = 0;
+    for (int b = row_offsets[r]; b < row_offsets[r + 1]; b++) {
+        int begin = bk[b] * MinMaxBricks::SIZE;
+        while (b + 1 < row_offsets[r + 1] && bk[b + 1] == bk[b] + 1)
+            b++;
+        ranges.push_back(begin);
+        ranges.push_back(std::min(Nk - 1, (bk[b] + 1) * MinMaxBricks::SIZE));
+        n_ranges++;
+    }
+    return n_ranges;
+}
+
+void SpanSpace::build(const MinMaxBricks &bricks) {
+    clear();
+    for (int axis = 0; axis < 3; axis++)
+        n_bricks[axis] = bricks.size(axis);
+
+    // constant bricks are never crossed by the surface
+    std::vector<int> ids;
+    for (int b = 0; b < bricks.count(); b++)
+        if (bricks.min(b) < bricks.max(b))
+            ids.push_back(b);
+
+    by_min.reserve(ids.size());
+    by_max.reserve(ids.size());
+    if (!ids.empty())
+        buildNode(bricks, ids);
+
+    min_sorted.resize(by_min.size());
+    max_sorted.resize(by_max.size());
+    for (size_t n = 0; n < by_min.size(); n++) {
+        min_sorted[n] = bricks.min(by_min[n]);
+        max_sorted[n] = bricks.max(by_max[n]);
+    }
+}
+
+int SpanSpace::buildNode(const MinMaxBricks &bricks, std::vector<int> &ids) {
+    // split at the median of the interval midpoints, so that at most half of them go to each side
+    std::vector<float> mid(ids.size());
+    for (size_t n = 0; n < ids.size(); n++)
+        mid[n] = 0.5f * (bricks.min(ids[n]) + bricks.max(ids[n]));
+    std::nth_element(mid.begin(), mid.begin() + mid.size() / 2, mid.end());
+    float split = mid[mid.size() / 2];
+
+    std::vector<int> below, above, crossing;
+    for (int b : ids) {
+        if (bricks.max(b) <= split)
+            below.push_back(b);
+        else if (bricks.min(b) > split)
+            above.push_back(b);
+        else
+            crossing.push_back(b);
+    }
+    ids.clear();
+    ids.shrink_to_fit();
+
+    int node = nodes.size();
+    nodes.push_back(Node());
+    nodes[node].split = split;
+    nodes[node].begin = by_min.size();
+
+    std::sort(crossing.begin(), crossing.end(), [&](int a, int b) {return bricks.min(a) < bricks.min(b);});
+    by_min.insert(by_min.end(), crossing.begin(), crossing.end());
+    std::sort(crossing.begin(), crossing.end(), [&](int a, int b) {return bricks.max(a) > bricks.max(b);});
+    by_max.insert(by_max.end(), crossing.begin(), crossing.end());
+    nodes[node].end = by_min.size();
+
+    int left = below.empty() ? -1 : buildNode(bricks, below);
+    int right = above.empty() ? -1 : buildNode(bricks, above);
+    nodes[node].left = left;
+    nodes[node].right = right;
+    return node;
+}
+
+void SpanSpace::clear() {
+    n_bricks[0] = n_bricks[1] = n_bricks[2] = 0;
+    nodes.clear();
+    by_min.clear();
+    by_max.clear();
+    min_sorted.clear();
+    max_sorted.clear();
+}
+
+void SpanSpace::query(float isovalue, std::vector<int> &result) const {
+    int node = nodes.empty() ? -1 : 0;
+    while (node >= 0) {
+        const Node &n = nodes[node];
+        if (isovalue < n.split) {
+            // all intervals of the node end above the isovalue
+            for (int b = n.begin; b < n.end && min_sorted[b] <= isovalue; b++)
+                result.push_back(by_min[b]);
+            node = n.left;
+        } else {
+            // all intervals of the node start below the isovalue
+            for (int b = n.begin; b < n.end && max_sorted[b] > isovalue; b++)
+                result.push_back(by_max[b]);
+            node = n.right;
+        }
+    }
+}
+
+void SpanSpace::activeBricks(float isovalue, ActiveBricks &active) const {
+    std::vector<int> bricks;
+    query(isovalue, bricks);
+    std::sort(bricks.begin(), bricks.end());
+
+    int n_rows = n_bricks[0]*n_bricks[1];
+    std::copy(n_bricks, n_bricks + 3, active.n_bricks);
+    active.bk.resize(bricks.size());
+    active.row_offsets.assign(n_rows + 1, 0);
+    for (size_t b = 0; b < bricks.size(); b++) {
+        active.bk[b] = bricks[b] % n_bricks[2];
+        active.row_offsets[bricks[b] / n_bricks[2] + 1]++;
+    }
+    for (int r = 0; r < n_rows; r++)
+        active.row_offsets[r + 1] += active.row_offsets[r];
+}
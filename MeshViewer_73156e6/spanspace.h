@@ -0,0 +1,72 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#ifndef __MeshViewer_spanspace_h_
+#define __MeshViewer_spanspace_h_
+#include <vector>
+#include "bricks.h"
+
+// Bricks whose range contains an isovalue, sorted by (bi, bj, bk) and grouped by rows of bricks
+struct ActiveBricks {
+  int n_bricks[3];              // bricks along each axis
+  std::vector<int> bk;          // k coordinate of the active bricks
+  std::vector<int> row_offsets; // the row (bi, bj) has bk[row_offsets[r]..row_offsets[r+1]), r = bi*n_bricks[1] + bj
+
+  // runs of consecutive active bricks of the row (bi, bj), as [begin, end) ranges of cells along
+  // k (for a volume with Nk samples along k) appended to ranges. Returns the number of runs.
+  int cellRanges(int bi, int bj, int Nk, std::vector<int> &ranges) const;
+};
+
+// Interval tree over the value ranges of the bricks of a volume. Finding the bricks that may be
+// crossed by the isosurface takes O(k + log n) for k active bricks out of n, instead of
+// checking all of them.
+class SpanSpace {
+ public:
+  SpanSpace() : n_bricks{0, 0, 0} {}
+  void build(const MinMaxBricks &bricks);
+  void clear();
+
+  // indices of the bricks whose range contains the isovalue, in no particular order
+  void query(float isovalue, std::vector<int> &result) const;
+  // same, sorted and grouped for a traversal in memory order
+  void activeBricks(float isovalue, ActiveBricks &active) const;
+  // bytes used by the tree
+  size_t memory() const {
+    return nodes.capacity() * sizeof(Node) + (by_min.capacity() + by_max.capacity()) * sizeof(int) +
+           (min_sorted.capacity() + max_sorted.capacity()) * sizeof(float);
+  }
+
+ private:
+  // intervals stored at a node are those containing its split value, i.e. active at the split,
+  // sorted by increasing min and by decreasing max. Intervals below the split go left, the
+  // ones above go right.
+  struct Node {
+    float split;
+    int left, right;
+    int begin, end;
+  };
+  int n_bricks[3];
+  std::vector<Node> nodes;
+  std::vector<int> by_min, by_max;
+  std::vector<float> min_sorted, max_sorted;
+
+  int buildNode(const MinMaxBricks &bricks, std::vector<int> &ids);
+};
+
+#endif // __MeshViewer_spanspace_h_
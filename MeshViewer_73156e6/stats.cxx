@@ -0,0 +1,65 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#include "stats.h"
+
+#include <fstream>
+#include <iostream>
+
+void ExtractionStats::clear() {
+    for (int s = 0; s < N_STAGES; s++) stage_seconds[s] = 0.;
+    for (int c = 0; c < N_COUNTERS; c++) counters[c] = 0;
+}
+
+void ExtractionStats::merge(const ExtractionStats &other) {
+    for (int s = 0; s < N_STAGES; s++) stage_seconds[s] += other.stage_seconds[s];
+    for (int c = 0; c < N_COUNTERS; c++) counters[c] += other.counters[c];
+}
+
+const char *ExtractionStats::name(Stage stage) {
+    static const char *names[N_STAGES] = {"load", "classify", "triangulate", "stitch", "update",
+                                          "normals", "mesh", "upload"};
+    return names[stage];
+}
+
+const char *ExtractionStats::name(Counter counter) {
+    static const char *names[N_COUNTERS] = {"active_cells", "vertices", "triangles", "edge_lookups",
+                                              "hash_probes"};
+    return names[counter];
+}
+
+void ExtractionStats::writeJson(std::ostream &out) const {
+    out << "{\n  \"stages\": {";
+    for (int s = 0; s < N_STAGES; s++)
+        out << (s ? ",\n" : "\n") << "    \"" << name(Stage(s)) << "\": " << stage_seconds[s];
+    out << "\n  },\n  \"counters\": {";
+    for (int c = 0; c < N_COUNTERS; c++)
+        out << (c ? ",\n" : "\n") << "    \"" << name(Counter(c)) << "\": " << counters[c];
+    out << "\n  }\n}\n";
+}
+
+bool ExtractionStats::writeJson(const char *file_name) const {
+    std::ofstream out(file_name);
+    if (out) writeJson(out);
+    if (!out) {
+        std::cerr << "Error writing " << file_name << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,91 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#ifndef __MeshViewer_stats_h_
+#define __MeshViewer_stats_h_
+#include <cstddef>
+#include <chrono>
+#include <ostream>
+
+// Time spent in each stage of an extraction and counts of the work done, to find where the
+// time goes. Stages run by the worker threads (CLASSIFY, TRIANGULATE) add the time of every
+// thread, the others are wall time.
+class ExtractionStats {
+ public:
+  typedef enum {
+    LOAD=0,      // finding the volume in the cache, or reading it
+    CLASSIFY,    // finding the active cells of each row
+    TRIANGULATE, // triangles and vertices of the active cells (reconstructVoxel)
+    STITCH,      // joining the slabs of the worker threads
+    UPDATE,      // updating the last isosurface when only the isovalue changes
+    NORMALS,     // vertex normals from the triangles around them
+    MESH,        // conversion to an OpenMesh mesh (HALFEDGE_MESH) or to interleaved buffers
+    UPLOAD,      // copy to the GL buffers
+    N_STAGES
+  } Stage;
+  typedef enum {
+    ACTIVE_CELLS=0, // cells crossed by the surface (once per isovalue crossing them)
+    VERTICES,
+    TRIANGLES,
+    EDGE_LOOKUPS,   // lookups of the vertex of an edge in the edge index of a slab or brick
+    HASH_PROBES,    // slots visited in the edge map of the incremental updates
+    N_COUNTERS
+  } Counter;
+
+  ExtractionStats() {clear();}
+  void clear();
+  void add(Stage stage, double seconds) {stage_seconds[stage] += seconds;}
+  void add(Counter counter, size_t n) {counters[counter] += n;}
+  // adds the stages and counters of other, such as those of a worker thread
+  void merge(const ExtractionStats &other);
+  double seconds(Stage stage) const {return stage_seconds[stage];}
+  size_t count(Counter counter) const {return counters[counter];}
+  static const char *name(Stage stage);
+  static const char *name(Counter counter);
+
+  // {"stages": {"load": seconds, ...}, "counters": {"active_cells": n, ...}}
+  void writeJson(std::ostream &out) const;
+  bool writeJson(const char *file_name) const;
+
+ private:
+  double stage_seconds[N_STAGES];
+  size_t counters[N_COUNTERS];
+};
+
+// Adds the time from its construction to its destruction to a stage. With null stats it does
+// nothing, not even reading the clock, so it can be left in the inner loops.
+class StageTimer {
+ public:
+  StageTimer(ExtractionStats *stats, ExtractionStats::Stage stage) : stats(stats), stage(stage) {
+    if (stats) start = std::chrono::steady_clock::now();
+  }
+  ~StageTimer() {
+    if (stats) stats->add(stage, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+
+ private:
+  ExtractionStats *stats;
+  ExtractionStats::Stage stage;
+  std::chrono::steady_clock::time_point start;
+
+  StageTimer(const StageTimer &);
+  StageTimer &operator=(const StageTimer &);
+};
+
+#endif // __MeshViewer_stats_h_
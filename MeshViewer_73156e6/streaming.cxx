@@ -0,0 +1,180 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#include "streaming.h"
+
+#include <fstream>
+#include <iostream>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "classify.h"
+#include "taulaMC.hpp"
+#include "volume.h"
+
+static const uint32_t NO_VERTEX = UINT32_MAX;
+
+void ObjWriter::addVertices(const float *positions, size_t n_vertices) {
+    for (size_t v = 0; v < n_vertices; v++, positions += 3)
+        out << "v " << positions[0] << " " << positions[1] << " " << positions[2] << "\n";
+}
+
+void ObjWriter::addTriangles(const uint32_t *indices, size_t n_triangles) {
+    // OBJ indices start at 1
+    for (size_t t = 0; t < n_triangles; t++, indices += 3)
+        out << "f " << indices[0] + 1 << " " << indices[1] + 1 << " " << indices[2] + 1 << "\n";
+}
+
+bool StreamingExtractor::extract(const char *name, MeshSink &sink) {
+    if (MappedVolume::isBinary(name)) {
+        // the slices are read from the file as they are needed, instead of mapping it whole
+        std::ifstream volume_file(name, std::ios::binary);
+        VolumeHeader header;
+        volume_file.read((char *) &header, sizeof(header));
+        if (!volume_file || header.version != VOLUME_VERSION || header.type >= VOLUME_TYPE_COUNT) {
+            std::cerr << "Invalid binary volume " << name << std::endl;
+            return false;
+        }
+        Grid grid;
+        for (int axis = 0; axis < 3; axis++) {
+            grid.dims[axis] = header.dims[axis];
+            grid.spacing[axis] = header.spacing[axis];
+            grid.origin[axis] = header.origin[axis];
+        }
+        return extract(volume_file, grid, (VolumeType) header.type, sink);
+    }
+
+    std::ifstream volume_file(name);
+    Grid grid;
+    if (!volume_file.is_open() || !grid.readHeader(volume_file)) {
+        std::cerr << "Error reading volume " << name << std::endl;
+        return false;
+    }
+    return extract(volume_file, grid, sink);
+}
+
+bool StreamingExtractor::extract(std::istream &volume_file, const Grid &grid, MeshSink &sink) {
+    this->grid = grid;
+    binary = false;
+    return extractSlices(volume_file, sink);
+}
+
+bool StreamingExtractor::extract(std::istream &volume_file, const Grid &grid, VolumeType type, MeshSink &sink) {
+    this->grid = grid;
+    this->type = type;
+    binary = true;
+    raw_slice.resize((size_t)grid.dims[1]*grid.dims[2]*volumeTypeSize(type));
+    return extractSlices(volume_file, sink);
+}
+
+bool StreamingExtractor::extractSlices(std::istream &volume_file, MeshSink &sink) {
+    vertex_count = triangle_count = 0;
+    if (!grid.valid()) return false;
+
+    const int Ni = grid.dims[0], Nj = grid.dims[1], Nk = grid.dims[2];
+    slices[0].resize(Nj*Nk);
+    slices[1].resize(Nj*Nk);
+    vertex_ids.assign(2*Nj*Nk*3, NO_VERTEX);
+
+    std::vector<unsigned char> cases(Nk);
+    std::vector<int> active(Nk);
+
+    if (!readSlice(volume_file, 0)) return false;
+    for (int i = 0; i < Ni - 1; i++) {
+        if (!readSlice(volume_file, i + 1)) return false;
+        clearPlane(i + 1);
+
+        const float *slice_0 = slices[i & 1].data(), *slice_1 = slices[(i + 1) & 1].data();
+        for (int j = 0; j < Nj - 1; j++) {
+            const float *row = slice_0 + j*Nk, *next_row = slice_1 + j*Nk;
+            int n_active = classifyRow(row, row + Nk, next_row, next_row + Nk, Nk - 1, isovalue,
+                                       cases.data(), active.data());
+            for (int a = 0; a < n_active; a++)
+                extractCell(cases[active[a]], i, j, active[a]);
+        }
+
+        flush(sink);
+    }
+    return true;
+}
+
+bool StreamingExtractor::readSlice(std::istream &volume_file, int i) {
+    std::vector<float> &slice = slices[i & 1];
+    if (binary) {
+        volume_file.read(raw_slice.data(), raw_slice.size());
+        for (size_t s = 0; s < slice.size(); s++)
+            slice[s] = sampleValue(raw_slice.data(), type, s);
+    } else {
+        for (size_t s = 0; s < slice.size(); s++)
+            volume_file >> slice[s];
+    }
+    if (!volume_file) {
+        std::cerr << "Volume file ends before slice " << i << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void StreamingExtractor::clearPlane(int i) {
+    size_t plane_edges = (size_t)grid.dims[1]*grid.dims[2]*3;
+    std::fill(vertex_ids.begin() + (i & 1)*plane_edges, vertex_ids.begin() + ((i & 1) + 1)*plane_edges, NO_VERTEX);
+}
+
+void StreamingExtractor::extractCell(int config, int i, int j, int k) {
+    const int Nj = grid.dims[1], Nk = grid.dims[2];
+    const MCcase &recons = MC_CASES[config];
+
+    for (int t = 0; t < recons.n_triangles; t++) {
+        for (int v = 0; v < 3; v++) {
+            const int *edge = MC_EDGES[recons.edges[3*t + v]];
+            const int *vert_0 = MC_CORNERS[edge[0]], *vert_1 = MC_CORNERS[edge[1]];
+            int axis = vert_0[0] != vert_1[0] ? 0 : vert_0[1] != vert_1[1] ? 1 : 2;
+            int origin[3] = {std::min(vert_0[0], vert_1[0]), std::min(vert_0[1], vert_1[1]), std::min(vert_0[2], vert_1[2])};
+            uint32_t &vtx_idx = vertex_ids[((((i + origin[0]) & 1)*Nj + j + origin[1])*Nk + k + origin[2])*3 + axis];
+
+            if (vtx_idx == NO_VERTEX) {
+                const int end[3] = {origin[0] + (axis == 0), origin[1] + (axis == 1), origin[2] + (axis == 2)};
+                glm::vec3 endpoint_0_indices = {i + origin[0], j + origin[1], k + origin[2]};
+                glm::vec3 endpoint_1_indices = {i + end[0], j + end[1], k + end[2]};
+                float end_point_0 = slices[(i + origin[0]) & 1][(j + origin[1])*Nk + k + origin[2]];
+                float end_point_1 = slices[(i + end[0]) & 1][(j + end[1])*Nk + k + end[2]];
+
+                // same interpolation as Scene::edgePoint, so both give the same vertices
+                float alpha = (isovalue - end_point_0) / (end_point_1 - end_point_0);
+                glm::vec3 vtx = glm::make_vec3(grid.origin) + glm::mix(endpoint_0_indices * glm::make_vec3(grid.spacing),
+                                                                       endpoint_1_indices * glm::make_vec3(grid.spacing), alpha);
+
+                vtx_idx = vertex_count + points.size() / 3;
+                points.insert(points.end(), &vtx.x, &vtx.x + 3);
+            }
+            triangles.push_back(vtx_idx);
+        }
+    }
+}
+
+void StreamingExtractor::flush(MeshSink &sink) {
+    if (!points.empty())
+        sink.addVertices(points.data(), points.size() / 3);
+    if (!triangles.empty())
+        sink.addTriangles(triangles.data(), triangles.size() / 3);
+    vertex_count += points.size() / 3;
+    triangle_count += triangles.size() / 3;
+    points.clear();
+    triangles.clear();
+}
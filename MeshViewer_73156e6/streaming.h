@@ -0,0 +1,90 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#ifndef __MeshViewer_streaming_h_
+#define __MeshViewer_streaming_h_
+#include <vector>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include "grid.h"
+#include "scalar.h"
+
+// Receives the output of a streaming extraction as it is produced. Vertices are numbered in
+// the order they are added, starting at 0, and are always added before the triangles using them.
+class MeshSink {
+ public:
+  virtual ~MeshSink() {}
+  virtual void addVertices(const float *positions, size_t n_vertices) = 0;
+  virtual void addTriangles(const uint32_t *indices, size_t n_triangles) = 0;
+};
+
+// writes the mesh as a Wavefront OBJ file, with the positions written in full precision
+class ObjWriter : public MeshSink {
+ public:
+  ObjWriter(std::ostream &out) : out(out) {out.precision(std::numeric_limits<float>::max_digits10);}
+  void addVertices(const float *positions, size_t n_vertices);
+  void addTriangles(const uint32_t *indices, size_t n_triangles);
+
+ private:
+  std::ostream &out;
+};
+
+// Marching cubes over a volume read one slice (plane of constant i) at a time. Only the two
+// slices of the current plane of cells and the vertices on their edges are kept in memory,
+// and the triangles of each plane of cells are handed to the sink as soon as it is done, so
+// the size of the volume is not limited by the available memory.
+class StreamingExtractor {
+ public:
+  StreamingExtractor(float isovalue) : isovalue(isovalue), vertex_count(0), triangle_count(0),
+                                       binary(false), type(VOLUME_FLOAT32) {}
+
+  // extracts the isosurface of a text or binary volume file
+  bool extract(const char *name, MeshSink &sink);
+  // same, for a text volume whose header has already been read
+  bool extract(std::istream &volume_file, const Grid &grid, MeshSink &sink);
+  // same, for a binary volume whose header has already been read: the samples of each slice
+  // are read in a single block and converted from their type
+  bool extract(std::istream &volume_file, const Grid &grid, VolumeType type, MeshSink &sink);
+
+  size_t n_vertices() const {return vertex_count;}
+  size_t n_triangles() const {return triangle_count;}
+
+ private:
+  float isovalue;
+  size_t vertex_count, triangle_count;
+
+  Grid grid;
+  bool binary;
+  VolumeType type;                      // of the samples of a binary volume
+  std::vector<char> raw_slice;          // samples of a binary volume as read from the file
+  std::vector<float> slices[2];         // samples of the planes i and i + 1, by parity of i
+  std::vector<uint32_t> vertex_ids;     // vertex on each edge of the two planes, as in Scene::EdgeIndex
+  std::vector<float> points;            // vertices of the current plane of cells
+  std::vector<uint32_t> triangles;      // triangles of the current plane of cells
+
+  bool extractSlices(std::istream &volume_file, MeshSink &sink);
+  bool readSlice(std::istream &volume_file, int i);
+  void clearPlane(int i);
+  void extractCell(int config, int i, int j, int k);
+  void flush(MeshSink &sink);
+};
+
+#endif // __MeshViewer_streaming_h_
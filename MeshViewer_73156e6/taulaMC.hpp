@@ -1,270 +1,316 @@
-#ifndef _TAULAMC_HPP_
-#include <vector>
-
-class MCcases {
-  std::vector<std::vector<std::vector<int> > > casos = {
-    {},
-    {{3, 10, 0 }},
-    {{11, 3, 2 }},
-    {{11, 0, 2 }, {11, 10, 0 }},
-    {{10, 7, 4 }},
-    {{3, 4, 0 }, {3, 7, 4 }},
-    {{10, 2, 4 }, {2, 7, 4 }, {2, 11, 7 }, {10, 3, 2 }},
-    {{11, 0, 2 }, {11, 4, 0 }, {11, 7, 4 }},
-    {{7, 11, 6 }},
-    {{7, 0, 6 }, {0, 11, 6 }, {0, 3, 11 }, {7, 10, 0 }},
-    {{7, 2, 6 }, {7, 3, 2 }},
-    {{7, 2, 6 }, {7, 0, 2 }, {7, 10, 0 }},
-    {{10, 6, 4 }, {10, 11, 6 }},
-    {{3, 4, 0 }, {3, 6, 4 }, {3, 11, 6 }},
-    {{10, 6, 4 }, {10, 2, 6 }, {10, 3, 2 }},
-    {{4, 2, 6 }, {4, 0, 2 }},
-    {{8, 1, 0 }},
-    {{8, 3, 10 }, {8, 1, 3 }},
-    {{8, 3, 0 }, {8, 11, 3 }, {8, 2, 11 }, {8, 1, 2 }},
-    {{8, 11, 10 }, {8, 2, 11 }, {8, 1, 2 }},
-    {{8, 7, 4 }, {8, 1, 7 }, {1, 10, 7 }, {1, 0, 10 }},
-    {{8, 7, 4 }, {8, 3, 7 }, {8, 1, 3 }},
-    {{8, 7, 4 }, {8, 11, 7 }, {8, 2, 11 }, {8, 1, 2 }, {3, 0, 10 }},
-    {{8, 7, 4 }, {8, 11, 7 }, {8, 2, 11 }, {8, 1, 2 }},
-    {{8, 6, 7 }, {11, 6, 1 }, {0, 7, 11 }, {6, 8, 1 }, {0, 8, 7 }, {11, 1, 0 }},
-    {{8, 7, 10 }, {8, 6, 7 }, {8, 11, 6 }, {8, 3, 11 }, {8, 1, 3 }},
-    {{8, 3, 0 }, {8, 7, 3 }, {8, 6, 7 }, {8, 2, 6 }, {8, 1, 2 }},
-    {{8, 7, 10 }, {8, 6, 7 }, {8, 2, 6 }, {8, 1, 2 }},
-    {{8, 6, 4 }, {8, 11, 6 }, {8, 1, 11 }, {1, 10, 11 }, {1, 0, 10 }},
-    {{8, 6, 4 }, {8, 11, 6 }, {8, 3, 11 }, {8, 1, 3 }},
-    {{8, 6, 4 }, {8, 2, 6 }, {8, 1, 2 }, {3, 0, 10 }},
-    {{8, 6, 4 }, {8, 2, 6 }, {8, 1, 2 }},
-    {{1, 9, 2 }},
-    {{1, 10, 0 }, {1, 9, 10 }, {9, 3, 10 }, {9, 2, 3 }},
-    {{1, 11, 3 }, {1, 9, 11 }},
-    {{1, 10, 0 }, {1, 11, 10 }, {1, 9, 11 }},
-    {{1, 4, 10 }, {9, 7, 4 }, {10, 7, 2 }, {7, 9, 2 }, {4, 1, 9 }, {2, 1, 10 }},
-    {{1, 4, 0 }, {1, 7, 4 }, {1, 9, 7 }, {9, 3, 7 }, {9, 2, 3 }},
-    {{1, 10, 3 }, {1, 4, 10 }, {1, 7, 4 }, {1, 11, 7 }, {1, 9, 11 }},
-    {{1, 4, 0 }, {1, 7, 4 }, {1, 11, 7 }, {1, 9, 11 }},
-    {{1, 11, 2 }, {1, 7, 11 }, {1, 6, 7 }, {1, 9, 6 }},
-    {{1, 10, 0 }, {1, 7, 10 }, {1, 6, 7 }, {1, 9, 6 }, {2, 3, 11 }},
-    {{1, 7, 3 }, {1, 6, 7 }, {1, 9, 6 }},
-    {{1, 10, 0 }, {1, 7, 10 }, {1, 6, 7 }, {1, 9, 6 }},
-    {{1, 11, 2 }, {1, 10, 11 }, {1, 4, 10 }, {1, 6, 4 }, {1, 9, 6 }},
-    {{1, 4, 0 }, {1, 6, 4 }, {1, 9, 6 }, {2, 3, 11 }},
-    {{1, 10, 3 }, {1, 4, 10 }, {1, 6, 4 }, {1, 9, 6 }},
-    {{1, 4, 0 }, {1, 6, 4 }, {1, 9, 6 }},
-    {{8, 2, 0 }, {8, 9, 2 }},
-    {{8, 3, 10 }, {8, 2, 3 }, {8, 9, 2 }},
-    {{8, 3, 0 }, {8, 11, 3 }, {8, 9, 11 }},
-    {{8, 11, 10 }, {8, 9, 11 }},
-    {{8, 7, 4 }, {8, 2, 7 }, {2, 10, 7 }, {2, 0, 10 }, {8, 9, 2 }},
-    {{8, 7, 4 }, {8, 3, 7 }, {8, 2, 3 }, {8, 9, 2 }},
-    {{8, 7, 4 }, {8, 11, 7 }, {8, 9, 11 }, {3, 0, 10 }},
-    {{8, 7, 4 }, {8, 11, 7 }, {8, 9, 11 }},
-    {{8, 2, 0 }, {8, 11, 2 }, {8, 7, 11 }, {8, 6, 7 }, {8, 9, 6 }},
-    {{8, 7, 10 }, {8, 6, 7 }, {8, 9, 6 }, {2, 3, 11 }},
-    {{8, 3, 0 }, {8, 7, 3 }, {8, 6, 7 }, {8, 9, 6 }},
-    {{8, 7, 10 }, {8, 6, 7 }, {8, 9, 6 }},
-    {{8, 6, 4 }, {8, 9, 6 }, {2, 10, 11 }, {2, 0, 10 }},
-    {{8, 6, 4 }, {8, 9, 6 }, {2, 3, 11 }},
-    {{8, 6, 4 }, {8, 9, 6 }, {3, 0, 10 }},
-    {{8, 6, 4 }, {8, 9, 6 }},
-    {{5, 8, 4 }},
-    {{5, 10, 4 }, {5, 3, 10 }, {5, 0, 3 }, {5, 8, 0 }},
-    {{5, 2, 11 }, {8, 3, 2 }, {11, 3, 4 }, {3, 8, 4 }, {2, 5, 8 }, {4, 5, 11 }},
-    {{5, 10, 4 }, {5, 11, 10 }, {5, 2, 11 }, {5, 0, 2 }, {5, 8, 0 }},
-    {{5, 10, 7 }, {5, 8, 10 }},
-    {{5, 3, 7 }, {5, 0, 3 }, {5, 8, 0 }},
-    {{5, 11, 7 }, {5, 2, 11 }, {5, 3, 2 }, {5, 10, 3 }, {5, 8, 10 }},
-    {{5, 11, 7 }, {5, 2, 11 }, {5, 0, 2 }, {5, 8, 0 }},
-    {{5, 11, 6 }, {5, 8, 11 }, {8, 7, 11 }, {8, 4, 7 }},
-    {{5, 11, 6 }, {5, 3, 11 }, {5, 0, 3 }, {5, 8, 0 }, {4, 7, 10 }},
-    {{5, 2, 6 }, {5, 3, 2 }, {5, 8, 3 }, {8, 7, 3 }, {8, 4, 7 }},
-    {{5, 2, 6 }, {5, 0, 2 }, {5, 8, 0 }, {4, 7, 10 }},
-    {{5, 11, 6 }, {5, 10, 11 }, {5, 8, 10 }},
-    {{5, 11, 6 }, {5, 3, 11 }, {5, 0, 3 }, {5, 8, 0 }},
-    {{5, 2, 6 }, {5, 3, 2 }, {5, 10, 3 }, {5, 8, 10 }},
-    {{5, 2, 6 }, {5, 0, 2 }, {5, 8, 0 }},
-    {{5, 0, 4 }, {5, 1, 0 }},
-    {{5, 10, 4 }, {5, 3, 10 }, {5, 1, 3 }},
-    {{5, 0, 4 }, {5, 3, 0 }, {5, 11, 3 }, {5, 2, 11 }, {5, 1, 2 }},
-    {{5, 10, 4 }, {5, 11, 10 }, {5, 2, 11 }, {5, 1, 2 }},
-    {{5, 10, 7 }, {5, 0, 10 }, {5, 1, 0 }},
-    {{5, 3, 7 }, {5, 1, 3 }},
-    {{5, 11, 7 }, {5, 2, 11 }, {5, 1, 2 }, {3, 0, 10 }},
-    {{5, 11, 7 }, {5, 2, 11 }, {5, 1, 2 }},
-    {{5, 11, 6 }, {5, 0, 11 }, {0, 7, 11 }, {0, 4, 7 }, {5, 1, 0 }},
-    {{5, 11, 6 }, {5, 3, 11 }, {5, 1, 3 }, {10, 4, 7 }},
-    {{5, 2, 6 }, {5, 1, 2 }, {3, 4, 7 }, {3, 0, 4 }},
-    {{5, 2, 6 }, {5, 1, 2 }, {4, 7, 10 }},
-    {{5, 11, 6 }, {5, 10, 11 }, {5, 0, 10 }, {5, 1, 0 }},
-    {{5, 11, 6 }, {5, 3, 11 }, {5, 1, 3 }},
-    {{5, 2, 6 }, {5, 1, 2 }, {3, 0, 10 }},
-    {{5, 2, 6 }, {5, 1, 2 }},
-    {{1, 4, 2 }, {4, 9, 2 }, {4, 5, 9 }, {1, 8, 4 }},
-    {{1, 8, 0 }, {2, 5, 9 }, {2, 4, 5 }, {2, 10, 4 }, {2, 3, 10 }},
-    {{1, 11, 3 }, {1, 4, 11 }, {4, 9, 11 }, {4, 5, 9 }, {1, 8, 4 }},
-    {{1, 8, 0 }, {9, 4, 5 }, {9, 10, 4 }, {9, 11, 10 }},
-    {{1, 7, 2 }, {1, 10, 7 }, {7, 9, 2 }, {7, 5, 9 }, {1, 8, 10 }},
-    {{1, 8, 0 }, {2, 5, 9 }, {2, 7, 5 }, {2, 3, 7 }},
-    {{1, 10, 3 }, {1, 8, 10 }, {7, 9, 11 }, {7, 5, 9 }},
-    {{1, 8, 0 }, {9, 7, 5 }, {9, 11, 7 }},
-    {{1, 11, 2 }, {1, 7, 11 }, {1, 4, 7 }, {1, 8, 4 }, {6, 5, 9 }},
-    {{1, 8, 0 }, {2, 3, 11 }, {4, 7, 10 }, {9, 6, 5 }},
-    {{1, 7, 3 }, {1, 4, 7 }, {1, 8, 4 }, {6, 5, 9 }},
-    {{1, 8, 0 }, {4, 7, 10 }, {9, 6, 5 }},
-    {{1, 11, 2 }, {1, 10, 11 }, {1, 8, 10 }, {6, 5, 9 }},
-    {{1, 8, 0 }, {2, 3, 11 }, {9, 6, 5 }},
-    {{1, 10, 3 }, {1, 8, 10 }, {6, 5, 9 }},
-    {{1, 8, 0 }, {9, 6, 5 }},
-    {{5, 0, 4 }, {5, 2, 0 }, {5, 9, 2 }},
-    {{5, 10, 4 }, {5, 3, 10 }, {5, 2, 3 }, {5, 9, 2 }},
-    {{5, 0, 4 }, {5, 3, 0 }, {5, 11, 3 }, {5, 9, 11 }},
-    {{5, 10, 4 }, {5, 11, 10 }, {5, 9, 11 }},
-    {{5, 10, 7 }, {5, 0, 10 }, {5, 2, 0 }, {5, 9, 2 }},
-    {{5, 3, 7 }, {5, 2, 3 }, {5, 9, 2 }},
-    {{5, 11, 7 }, {5, 9, 11 }, {3, 0, 10 }},
-    {{5, 11, 7 }, {5, 9, 11 }},
-    {{5, 9, 6 }, {2, 7, 11 }, {2, 4, 7 }, {2, 0, 4 }},
-    {{5, 9, 6 }, {2, 3, 11 }, {4, 7, 10 }},
-    {{5, 9, 6 }, {3, 4, 7 }, {3, 0, 4 }},
-    {{5, 9, 6 }, {4, 7, 10 }},
-    {{5, 9, 6 }, {2, 10, 11 }, {2, 0, 10 }},
-    {{5, 9, 6 }, {2, 3, 11 }},
-    {{5, 0, 10 }, {9, 3, 0 }, {10, 3, 6 }, {3, 9, 6 }, {0, 5, 9 }, {6, 5, 10 }},
-    {{5, 9, 6 }},
-    {{9, 5, 6 }},
-    {{9, 0, 3 }, {10, 0, 5 }, {6, 3, 10 }, {0, 9, 5 }, {6, 9, 3 }, {10, 5, 6 }},
-    {{9, 3, 2 }, {9, 5, 3 }, {5, 11, 3 }, {5, 6, 11 }},
-    {{9, 0, 2 }, {9, 10, 0 }, {9, 5, 10 }, {5, 11, 10 }, {5, 6, 11 }},
-    {{9, 7, 6 }, {9, 10, 7 }, {9, 4, 10 }, {9, 5, 4 }},
-    {{9, 7, 6 }, {9, 3, 7 }, {9, 0, 3 }, {9, 4, 0 }, {9, 5, 4 }},
-    {{9, 3, 2 }, {9, 10, 3 }, {9, 4, 10 }, {9, 5, 4 }, {7, 6, 11 }},
-    {{9, 0, 2 }, {9, 4, 0 }, {9, 5, 4 }, {6, 11, 7 }},
-    {{9, 7, 11 }, {9, 5, 7 }},
-    {{9, 3, 11 }, {9, 0, 3 }, {9, 10, 0 }, {9, 7, 10 }, {9, 5, 7 }},
-    {{9, 3, 2 }, {9, 7, 3 }, {9, 5, 7 }},
-    {{9, 0, 2 }, {9, 10, 0 }, {9, 7, 10 }, {9, 5, 7 }},
-    {{9, 10, 11 }, {9, 4, 10 }, {9, 5, 4 }},
-    {{9, 3, 11 }, {9, 0, 3 }, {9, 4, 0 }, {9, 5, 4 }},
-    {{9, 3, 2 }, {9, 10, 3 }, {9, 4, 10 }, {9, 5, 4 }},
-    {{9, 0, 2 }, {9, 4, 0 }, {9, 5, 4 }},
-    {{9, 0, 6 }, {0, 5, 6 }, {0, 8, 5 }, {9, 1, 0 }},
-    {{9, 10, 6 }, {9, 3, 10 }, {10, 5, 6 }, {10, 8, 5 }, {9, 1, 3 }},
-    {{9, 1, 2 }, {3, 6, 11 }, {3, 5, 6 }, {3, 8, 5 }, {3, 0, 8 }},
-    {{9, 1, 2 }, {5, 10, 8 }, {5, 11, 10 }, {5, 6, 11 }},
-    {{9, 7, 6 }, {9, 10, 7 }, {9, 0, 10 }, {9, 1, 0 }, {4, 8, 5 }},
-    {{9, 7, 6 }, {9, 3, 7 }, {9, 1, 3 }, {4, 8, 5 }},
-    {{9, 1, 2 }, {3, 0, 10 }, {5, 4, 8 }, {6, 11, 7 }},
-    {{9, 1, 2 }, {7, 6, 11 }, {5, 4, 8 }},
-    {{9, 7, 11 }, {9, 0, 7 }, {0, 5, 7 }, {0, 8, 5 }, {9, 1, 0 }},
-    {{9, 3, 11 }, {9, 1, 3 }, {5, 10, 8 }, {5, 7, 10 }},
-    {{9, 1, 2 }, {3, 5, 7 }, {3, 8, 5 }, {3, 0, 8 }},
-    {{9, 1, 2 }, {5, 10, 8 }, {5, 7, 10 }},
-    {{9, 10, 11 }, {9, 0, 10 }, {9, 1, 0 }, {5, 4, 8 }},
-    {{9, 3, 11 }, {9, 1, 3 }, {5, 4, 8 }},
-    {{9, 1, 2 }, {3, 0, 10 }, {5, 4, 8 }},
-    {{9, 1, 2 }, {5, 4, 8 }},
-    {{1, 6, 2 }, {1, 5, 6 }},
-    {{1, 10, 0 }, {1, 6, 10 }, {6, 3, 10 }, {6, 2, 3 }, {1, 5, 6 }},
-    {{1, 11, 3 }, {1, 6, 11 }, {1, 5, 6 }},
-    {{1, 10, 0 }, {1, 11, 10 }, {1, 6, 11 }, {1, 5, 6 }},
-    {{1, 6, 2 }, {1, 7, 6 }, {1, 10, 7 }, {1, 4, 10 }, {1, 5, 4 }},
-    {{1, 4, 0 }, {1, 5, 4 }, {2, 7, 6 }, {2, 3, 7 }},
-    {{1, 10, 3 }, {1, 4, 10 }, {1, 5, 4 }, {7, 6, 11 }},
-    {{1, 4, 0 }, {1, 5, 4 }, {6, 11, 7 }},
-    {{1, 11, 2 }, {1, 7, 11 }, {1, 5, 7 }},
-    {{1, 10, 0 }, {1, 7, 10 }, {1, 5, 7 }, {2, 3, 11 }},
-    {{1, 7, 3 }, {1, 5, 7 }},
-    {{1, 10, 0 }, {1, 7, 10 }, {1, 5, 7 }},
-    {{1, 11, 2 }, {1, 10, 11 }, {1, 4, 10 }, {1, 5, 4 }},
-    {{1, 4, 0 }, {1, 5, 4 }, {2, 3, 11 }},
-    {{1, 10, 3 }, {1, 4, 10 }, {1, 5, 4 }},
-    {{1, 4, 0 }, {1, 5, 4 }},
-    {{8, 2, 0 }, {8, 6, 2 }, {8, 5, 6 }},
-    {{8, 3, 10 }, {8, 2, 3 }, {8, 6, 2 }, {8, 5, 6 }},
-    {{8, 3, 0 }, {8, 11, 3 }, {8, 6, 11 }, {8, 5, 6 }},
-    {{8, 11, 10 }, {8, 6, 11 }, {8, 5, 6 }},
-    {{8, 5, 4 }, {2, 7, 6 }, {2, 10, 7 }, {2, 0, 10 }},
-    {{8, 5, 4 }, {2, 7, 6 }, {2, 3, 7 }},
-    {{8, 5, 4 }, {3, 0, 10 }, {6, 11, 7 }},
-    {{8, 5, 4 }, {7, 6, 11 }},
-    {{8, 2, 0 }, {8, 11, 2 }, {8, 7, 11 }, {8, 5, 7 }},
-    {{8, 7, 10 }, {8, 5, 7 }, {2, 3, 11 }},
-    {{8, 3, 0 }, {8, 7, 3 }, {8, 5, 7 }},
-    {{8, 7, 10 }, {8, 5, 7 }},
-    {{8, 5, 4 }, {2, 10, 11 }, {2, 0, 10 }},
-    {{8, 2, 3 }, {11, 2, 5 }, {4, 3, 11 }, {2, 8, 5 }, {4, 8, 3 }, {11, 5, 4 }},
-    {{8, 5, 4 }, {3, 0, 10 }},
-    {{8, 5, 4 }},
-    {{9, 4, 6 }, {9, 8, 4 }},
-    {{9, 4, 6 }, {9, 10, 4 }, {9, 3, 10 }, {9, 0, 3 }, {9, 8, 0 }},
-    {{9, 3, 2 }, {9, 4, 3 }, {4, 11, 3 }, {4, 6, 11 }, {9, 8, 4 }},
-    {{9, 0, 2 }, {9, 8, 0 }, {6, 10, 4 }, {6, 11, 10 }},
-    {{9, 7, 6 }, {9, 10, 7 }, {9, 8, 10 }},
-    {{9, 7, 6 }, {9, 3, 7 }, {9, 0, 3 }, {9, 8, 0 }},
-    {{9, 3, 2 }, {9, 10, 3 }, {9, 8, 10 }, {7, 6, 11 }},
-    {{9, 0, 2 }, {9, 8, 0 }, {6, 11, 7 }},
-    {{9, 7, 11 }, {9, 4, 7 }, {9, 8, 4 }},
-    {{9, 3, 11 }, {9, 0, 3 }, {9, 8, 0 }, {4, 7, 10 }},
-    {{9, 3, 2 }, {9, 7, 3 }, {9, 4, 7 }, {9, 8, 4 }},
-    {{9, 0, 2 }, {9, 8, 0 }, {10, 4, 7 }},
-    {{9, 10, 11 }, {9, 8, 10 }},
-    {{9, 3, 11 }, {9, 0, 3 }, {9, 8, 0 }},
-    {{9, 3, 2 }, {9, 10, 3 }, {9, 8, 10 }},
-    {{9, 0, 2 }, {9, 8, 0 }},
-    {{9, 4, 6 }, {9, 0, 4 }, {9, 1, 0 }},
-    {{9, 4, 6 }, {9, 10, 4 }, {9, 3, 10 }, {9, 1, 3 }},
-    {{9, 1, 2 }, {3, 6, 11 }, {3, 4, 6 }, {3, 0, 4 }},
-    {{9, 1, 2 }, {4, 11, 10 }, {4, 6, 11 }},
-    {{9, 7, 6 }, {9, 10, 7 }, {9, 0, 10 }, {9, 1, 0 }},
-    {{9, 7, 6 }, {9, 3, 7 }, {9, 1, 3 }},
-    {{9, 1, 2 }, {3, 0, 10 }, {6, 11, 7 }},
-    {{9, 1, 2 }, {7, 6, 11 }},
-    {{9, 7, 11 }, {9, 4, 7 }, {9, 0, 4 }, {9, 1, 0 }},
-    {{9, 3, 11 }, {9, 1, 3 }, {4, 7, 10 }},
-    {{9, 1, 2 }, {3, 4, 7 }, {3, 0, 4 }},
-    {{9, 4, 7 }, {10, 4, 1 }, {2, 7, 10 }, {4, 9, 1 }, {2, 9, 7 }, {10, 1, 2 }},
-    {{9, 10, 11 }, {9, 0, 10 }, {9, 1, 0 }},
-    {{9, 3, 11 }, {9, 1, 3 }},
-    {{9, 1, 2 }, {3, 0, 10 }},
-    {{9, 1, 2 }},
-    {{1, 6, 2 }, {1, 4, 6 }, {1, 8, 4 }},
-    {{1, 8, 0 }, {2, 4, 6 }, {2, 10, 4 }, {2, 3, 10 }},
-    {{1, 11, 3 }, {1, 6, 11 }, {1, 4, 6 }, {1, 8, 4 }},
-    {{1, 8, 0 }, {6, 10, 4 }, {6, 11, 10 }},
-    {{1, 6, 2 }, {1, 7, 6 }, {1, 10, 7 }, {1, 8, 10 }},
-    {{1, 8, 0 }, {2, 7, 6 }, {2, 3, 7 }},
-    {{1, 10, 3 }, {1, 8, 10 }, {7, 6, 11 }},
-    {{1, 6, 11 }, {7, 6, 8 }, {0, 11, 7 }, {6, 1, 8 }, {0, 1, 11 }, {7, 8, 0 }},
-    {{1, 11, 2 }, {1, 7, 11 }, {1, 4, 7 }, {1, 8, 4 }},
-    {{1, 8, 0 }, {2, 3, 11 }, {4, 7, 10 }},
-    {{1, 7, 3 }, {1, 4, 7 }, {1, 8, 4 }},
-    {{1, 8, 0 }, {10, 4, 7 }},
-    {{1, 11, 2 }, {1, 10, 11 }, {1, 8, 10 }},
-    {{1, 8, 0 }, {2, 3, 11 }},
-    {{1, 10, 3 }, {1, 8, 10 }},
-    {{1, 8, 0 }},
-    {{0, 6, 2 }, {0, 4, 6 }},
-    {{3, 6, 2 }, {3, 4, 6 }, {3, 10, 4 }},
-    {{11, 4, 6 }, {11, 0, 4 }, {11, 3, 0 }},
-    {{11, 4, 6 }, {11, 10, 4 }},
-    {{10, 2, 0 }, {10, 6, 2 }, {10, 7, 6 }},
-    {{3, 6, 2 }, {3, 7, 6 }},
-    {{10, 3, 0 }, {7, 6, 11 }},
-    {{11, 7, 6 }},
-    {{7, 0, 4 }, {7, 2, 0 }, {7, 11, 2 }},
-    {{7, 10, 4 }, {2, 3, 11 }},
-    {{7, 0, 4 }, {7, 3, 0 }},
-    {{7, 10, 4 }},
-    {{10, 2, 0 }, {10, 11, 2 }},
-    {{3, 11, 2 }},
-    {{10, 3, 0 }},
-{},
-};
-
-public:
-  const std::vector<std::vector<int> >& operator()(int n) const {
-    return casos.at(n);
-  }
-};
-#define _TAULAMC_HPP_
-#endif
+#ifndef _TAULAMC_HPP_
+
+// Marching cubes tables. Corner n of a cube is at offset (n / 4, (n % 4) / 2, n % 2) from the
+// cube origin, and bit n of the case index is set when corner n is above the isovalue.
+
+// maximum number of triangles of a case
+#define MC_MAX_TRIANGLES 6
+
+// cube corners, as (i, j, k) offsets
+constexpr int MC_CORNERS[8][3] = {{0, 0, 0}, {0, 0, 1}, {0, 1, 0}, {0, 1, 1}, {1, 0, 0}, {1, 0, 1}, {1, 1, 0}, {1, 1, 1}};
+
+// cube edges, as pairs of corners
+constexpr int MC_EDGES[12][2] = {{0, 4}, {4, 5}, {5, 1}, {1, 0}, {2, 6}, {6, 7}, {7, 3}, {3, 2}, {4, 6}, {5, 7}, {0, 2}, {1, 3}};
+
+// triangles of each case, as triplets of the cube edges on which their vertices lie
+struct MCcase {
+  unsigned char n_triangles;
+  unsigned char edges[3*MC_MAX_TRIANGLES];
+};
+
+constexpr MCcase MC_CASES[256] = {
+    {0, {}},
+    {1, {3, 10, 0}},
+    {1, {11, 3, 2}},
+    {2, {11, 0, 2, 11, 10, 0}},
+    {1, {10, 7, 4}},
+    {2, {3, 4, 0, 3, 7, 4}},
+    {4, {10, 2, 4, 2, 7, 4, 2, 11, 7, 10, 3, 2}},
+    {3, {11, 0, 2, 11, 4, 0, 11, 7, 4}},
+    {1, {7, 11, 6}},
+    {4, {7, 0, 6, 0, 11, 6, 0, 3, 11, 7, 10, 0}},
+    {2, {7, 2, 6, 7, 3, 2}},
+    {3, {7, 2, 6, 7, 0, 2, 7, 10, 0}},
+    {2, {10, 6, 4, 10, 11, 6}},
+    {3, {3, 4, 0, 3, 6, 4, 3, 11, 6}},
+    {3, {10, 6, 4, 10, 2, 6, 10, 3, 2}},
+    {2, {4, 2, 6, 4, 0, 2}},
+    {1, {8, 1, 0}},
+    {2, {8, 3, 10, 8, 1, 3}},
+    {4, {8, 3, 0, 8, 11, 3, 8, 2, 11, 8, 1, 2}},
+    {3, {8, 11, 10, 8, 2, 11, 8, 1, 2}},
+    {4, {8, 7, 4, 8, 1, 7, 1, 10, 7, 1, 0, 10}},
+    {3, {8, 7, 4, 8, 3, 7, 8, 1, 3}},
+    {5, {8, 7, 4, 8, 11, 7, 8, 2, 11, 8, 1, 2, 3, 0, 10}},
+    {4, {8, 7, 4, 8, 11, 7, 8, 2, 11, 8, 1, 2}},
+    {6, {8, 6, 7, 11, 6, 1, 0, 7, 11, 6, 8, 1, 0, 8, 7, 11, 1, 0}},
+    {5, {8, 7, 10, 8, 6, 7, 8, 11, 6, 8, 3, 11, 8, 1, 3}},
+    {5, {8, 3, 0, 8, 7, 3, 8, 6, 7, 8, 2, 6, 8, 1, 2}},
+    {4, {8, 7, 10, 8, 6, 7, 8, 2, 6, 8, 1, 2}},
+    {5, {8, 6, 4, 8, 11, 6, 8, 1, 11, 1, 10, 11, 1, 0, 10}},
+    {4, {8, 6, 4, 8, 11, 6, 8, 3, 11, 8, 1, 3}},
+    {4, {8, 6, 4, 8, 2, 6, 8, 1, 2, 3, 0, 10}},
+    {3, {8, 6, 4, 8, 2, 6, 8, 1, 2}},
+    {1, {1, 9, 2}},
+    {4, {1, 10, 0, 1, 9, 10, 9, 3, 10, 9, 2, 3}},
+    {2, {1, 11, 3, 1, 9, 11}},
+    {3, {1, 10, 0, 1, 11, 10, 1, 9, 11}},
+    {6, {1, 4, 10, 9, 7, 4, 10, 7, 2, 7, 9, 2, 4, 1, 9, 2, 1, 10}},
+    {5, {1, 4, 0, 1, 7, 4, 1, 9, 7, 9, 3, 7, 9, 2, 3}},
+    {5, {1, 10, 3, 1, 4, 10, 1, 7, 4, 1, 11, 7, 1, 9, 11}},
+    {4, {1, 4, 0, 1, 7, 4, 1, 11, 7, 1, 9, 11}},
+    {4, {1, 11, 2, 1, 7, 11, 1, 6, 7, 1, 9, 6}},
+    {5, {1, 10, 0, 1, 7, 10, 1, 6, 7, 1, 9, 6, 2, 3, 11}},
+    {3, {1, 7, 3, 1, 6, 7, 1, 9, 6}},
+    {4, {1, 10, 0, 1, 7, 10, 1, 6, 7, 1, 9, 6}},
+    {5, {1, 11, 2, 1, 10, 11, 1, 4, 10, 1, 6, 4, 1, 9, 6}},
+    {4, {1, 4, 0, 1, 6, 4, 1, 9, 6, 2, 3, 11}},
+    {4, {1, 10, 3, 1, 4, 10, 1, 6, 4, 1, 9, 6}},
+    {3, {1, 4, 0, 1, 6, 4, 1, 9, 6}},
+    {2, {8, 2, 0, 8, 9, 2}},
+    {3, {8, 3, 10, 8, 2, 3, 8, 9, 2}},
+    {3, {8, 3, 0, 8, 11, 3, 8, 9, 11}},
+    {2, {8, 11, 10, 8, 9, 11}},
+    {5, {8, 7, 4, 8, 2, 7, 2, 10, 7, 2, 0, 10, 8, 9, 2}},
+    {4, {8, 7, 4, 8, 3, 7, 8, 2, 3, 8, 9, 2}},
+    {4, {8, 7, 4, 8, 11, 7, 8, 9, 11, 3, 0, 10}},
+    {3, {8, 7, 4, 8, 11, 7, 8, 9, 11}},
+    {5, {8, 2, 0, 8, 11, 2, 8, 7, 11, 8, 6, 7, 8, 9, 6}},
+    {4, {8, 7, 10, 8, 6, 7, 8, 9, 6, 2, 3, 11}},
+    {4, {8, 3, 0, 8, 7, 3, 8, 6, 7, 8, 9, 6}},
+    {3, {8, 7, 10, 8, 6, 7, 8, 9, 6}},
+    {4, {8, 6, 4, 8, 9, 6, 2, 10, 11, 2, 0, 10}},
+    {3, {8, 6, 4, 8, 9, 6, 2, 3, 11}},
+    {3, {8, 6, 4, 8, 9, 6, 3, 0, 10}},
+    {2, {8, 6, 4, 8, 9, 6}},
+    {1, {5, 8, 4}},
+    {4, {5, 10, 4, 5, 3, 10, 5, 0, 3, 5, 8, 0}},
+    {6, {5, 2, 11, 8, 3, 2, 11, 3, 4, 3, 8, 4, 2, 5, 8, 4, 5, 11}},
+    {5, {5, 10, 4, 5, 11, 10, 5, 2, 11, 5, 0, 2, 5, 8, 0}},
+    {2, {5, 10, 7, 5, 8, 10}},
+    {3, {5, 3, 7, 5, 0, 3, 5, 8, 0}},
+    {5, {5, 11, 7, 5, 2, 11, 5, 3, 2, 5, 10, 3, 5, 8, 10}},
+    {4, {5, 11, 7, 5, 2, 11, 5, 0, 2, 5, 8, 0}},
+    {4, {5, 11, 6, 5, 8, 11, 8, 7, 11, 8, 4, 7}},
+    {5, {5, 11, 6, 5, 3, 11, 5, 0, 3, 5, 8, 0, 4, 7, 10}},
+    {5, {5, 2, 6, 5, 3, 2, 5, 8, 3, 8, 7, 3, 8, 4, 7}},
+    {4, {5, 2, 6, 5, 0, 2, 5, 8, 0, 4, 7, 10}},
+    {3, {5, 11, 6, 5, 10, 11, 5, 8, 10}},
+    {4, {5, 11, 6, 5, 3, 11, 5, 0, 3, 5, 8, 0}},
+    {4, {5, 2, 6, 5, 3, 2, 5, 10, 3, 5, 8, 10}},
+    {3, {5, 2, 6, 5, 0, 2, 5, 8, 0}},
+    {2, {5, 0, 4, 5, 1, 0}},
+    {3, {5, 10, 4, 5, 3, 10, 5, 1, 3}},
+    {5, {5, 0, 4, 5, 3, 0, 5, 11, 3, 5, 2, 11, 5, 1, 2}},
+    {4, {5, 10, 4, 5, 11, 10, 5, 2, 11, 5, 1, 2}},
+    {3, {5, 10, 7, 5, 0, 10, 5, 1, 0}},
+    {2, {5, 3, 7, 5, 1, 3}},
+    {4, {5, 11, 7, 5, 2, 11, 5, 1, 2, 3, 0, 10}},
+    {3, {5, 11, 7, 5, 2, 11, 5, 1, 2}},
+    {5, {5, 11, 6, 5, 0, 11, 0, 7, 11, 0, 4, 7, 5, 1, 0}},
+    {4, {5, 11, 6, 5, 3, 11, 5, 1, 3, 10, 4, 7}},
+    {4, {5, 2, 6, 5, 1, 2, 3, 4, 7, 3, 0, 4}},
+    {3, {5, 2, 6, 5, 1, 2, 4, 7, 10}},
+    {4, {5, 11, 6, 5, 10, 11, 5, 0, 10, 5, 1, 0}},
+    {3, {5, 11, 6, 5, 3, 11, 5, 1, 3}},
+    {3, {5, 2, 6, 5, 1, 2, 3, 0, 10}},
+    {2, {5, 2, 6, 5, 1, 2}},
+    {4, {1, 4, 2, 4, 9, 2, 4, 5, 9, 1, 8, 4}},
+    {5, {1, 8, 0, 2, 5, 9, 2, 4, 5, 2, 10, 4, 2, 3, 10}},
+    {5, {1, 11, 3, 1, 4, 11, 4, 9, 11, 4, 5, 9, 1, 8, 4}},
+    {4, {1, 8, 0, 9, 4, 5, 9, 10, 4, 9, 11, 10}},
+    {5, {1, 7, 2, 1, 10, 7, 7, 9, 2, 7, 5, 9, 1, 8, 10}},
+    {4, {1, 8, 0, 2, 5, 9, 2, 7, 5, 2, 3, 7}},
+    {4, {1, 10, 3, 1, 8, 10, 7, 9, 11, 7, 5, 9}},
+    {3, {1, 8, 0, 9, 7, 5, 9, 11, 7}},
+    {5, {1, 11, 2, 1, 7, 11, 1, 4, 7, 1, 8, 4, 6, 5, 9}},
+    {4, {1, 8, 0, 2, 3, 11, 4, 7, 10, 9, 6, 5}},
+    {4, {1, 7, 3, 1, 4, 7, 1, 8, 4, 6, 5, 9}},
+    {3, {1, 8, 0, 4, 7, 10, 9, 6, 5}},
+    {4, {1, 11, 2, 1, 10, 11, 1, 8, 10, 6, 5, 9}},
+    {3, {1, 8, 0, 2, 3, 11, 9, 6, 5}},
+    {3, {1, 10, 3, 1, 8, 10, 6, 5, 9}},
+    {2, {1, 8, 0, 9, 6, 5}},
+    {3, {5, 0, 4, 5, 2, 0, 5, 9, 2}},
+    {4, {5, 10, 4, 5, 3, 10, 5, 2, 3, 5, 9, 2}},
+    {4, {5, 0, 4, 5, 3, 0, 5, 11, 3, 5, 9, 11}},
+    {3, {5, 10, 4, 5, 11, 10, 5, 9, 11}},
+    {4, {5, 10, 7, 5, 0, 10, 5, 2, 0, 5, 9, 2}},
+    {3, {5, 3, 7, 5, 2, 3, 5, 9, 2}},
+    {3, {5, 11, 7, 5, 9, 11, 3, 0, 10}},
+    {2, {5, 11, 7, 5, 9, 11}},
+    {4, {5, 9, 6, 2, 7, 11, 2, 4, 7, 2, 0, 4}},
+    {3, {5, 9, 6, 2, 3, 11, 4, 7, 10}},
+    {3, {5, 9, 6, 3, 4, 7, 3, 0, 4}},
+    {2, {5, 9, 6, 4, 7, 10}},
+    {3, {5, 9, 6, 2, 10, 11, 2, 0, 10}},
+    {2, {5, 9, 6, 2, 3, 11}},
+    {6, {5, 0, 10, 9, 3, 0, 10, 3, 6, 3, 9, 6, 0, 5, 9, 6, 5, 10}},
+    {1, {5, 9, 6}},
+    {1, {9, 5, 6}},
+    {6, {9, 0, 3, 10, 0, 5, 6, 3, 10, 0, 9, 5, 6, 9, 3, 10, 5, 6}},
+    {4, {9, 3, 2, 9, 5, 3, 5, 11, 3, 5, 6, 11}},
+    {5, {9, 0, 2, 9, 10, 0, 9, 5, 10, 5, 11, 10, 5, 6, 11}},
+    {4, {9, 7, 6, 9, 10, 7, 9, 4, 10, 9, 5, 4}},
+    {5, {9, 7, 6, 9, 3, 7, 9, 0, 3, 9, 4, 0, 9, 5, 4}},
+    {5, {9, 3, 2, 9, 10, 3, 9, 4, 10, 9, 5, 4, 7, 6, 11}},
+    {4, {9, 0, 2, 9, 4, 0, 9, 5, 4, 6, 11, 7}},
+    {2, {9, 7, 11, 9, 5, 7}},
+    {5, {9, 3, 11, 9, 0, 3, 9, 10, 0, 9, 7, 10, 9, 5, 7}},
+    {3, {9, 3, 2, 9, 7, 3, 9, 5, 7}},
+    {4, {9, 0, 2, 9, 10, 0, 9, 7, 10, 9, 5, 7}},
+    {3, {9, 10, 11, 9, 4, 10, 9, 5, 4}},
+    {4, {9, 3, 11, 9, 0, 3, 9, 4, 0, 9, 5, 4}},
+    {4, {9, 3, 2, 9, 10, 3, 9, 4, 10, 9, 5, 4}},
+    {3, {9, 0, 2, 9, 4, 0, 9, 5, 4}},
+    {4, {9, 0, 6, 0, 5, 6, 0, 8, 5, 9, 1, 0}},
+    {5, {9, 10, 6, 9, 3, 10, 10, 5, 6, 10, 8, 5, 9, 1, 3}},
+    {5, {9, 1, 2, 3, 6, 11, 3, 5, 6, 3, 8, 5, 3, 0, 8}},
+    {4, {9, 1, 2, 5, 10, 8, 5, 11, 10, 5, 6, 11}},
+    {5, {9, 7, 6, 9, 10, 7, 9, 0, 10, 9, 1, 0, 4, 8, 5}},
+    {4, {9, 7, 6, 9, 3, 7, 9, 1, 3, 4, 8, 5}},
+    {4, {9, 1, 2, 3, 0, 10, 5, 4, 8, 6, 11, 7}},
+    {3, {9, 1, 2, 7, 6, 11, 5, 4, 8}},
+    {5, {9, 7, 11, 9, 0, 7, 0, 5, 7, 0, 8, 5, 9, 1, 0}},
+    {4, {9, 3, 11, 9, 1, 3, 5, 10, 8, 5, 7, 10}},
+    {4, {9, 1, 2, 3, 5, 7, 3, 8, 5, 3, 0, 8}},
+    {3, {9, 1, 2, 5, 10, 8, 5, 7, 10}},
+    {4, {9, 10, 11, 9, 0, 10, 9, 1, 0, 5, 4, 8}},
+    {3, {9, 3, 11, 9, 1, 3, 5, 4, 8}},
+    {3, {9, 1, 2, 3, 0, 10, 5, 4, 8}},
+    {2, {9, 1, 2, 5, 4, 8}},
+    {2, {1, 6, 2, 1, 5, 6}},
+    {5, {1, 10, 0, 1, 6, 10, 6, 3, 10, 6, 2, 3, 1, 5, 6}},
+    {3, {1, 11, 3, 1, 6, 11, 1, 5, 6}},
+    {4, {1, 10, 0, 1, 11, 10, 1, 6, 11, 1, 5, 6}},
+    {5, {1, 6, 2, 1, 7, 6, 1, 10, 7, 1, 4, 10, 1, 5, 4}},
+    {4, {1, 4, 0, 1, 5, 4, 2, 7, 6, 2, 3, 7}},
+    {4, {1, 10, 3, 1, 4, 10, 1, 5, 4, 7, 6, 11}},
+    {3, {1, 4, 0, 1, 5, 4, 6, 11, 7}},
+    {3, {1, 11, 2, 1, 7, 11, 1, 5, 7}},
+    {4, {1, 10, 0, 1, 7, 10, 1, 5, 7, 2, 3, 11}},
+    {2, {1, 7, 3, 1, 5, 7}},
+    {3, {1, 10, 0, 1, 7, 10, 1, 5, 7}},
+    {4, {1, 11, 2, 1, 10, 11, 1, 4, 10, 1, 5, 4}},
+    {3, {1, 4, 0, 1, 5, 4, 2, 3, 11}},
+    {3, {1, 10, 3, 1, 4, 10, 1, 5, 4}},
+    {2, {1, 4, 0, 1, 5, 4}},
+    {3, {8, 2, 0, 8, 6, 2, 8, 5, 6}},
+    {4, {8, 3, 10, 8, 2, 3, 8, 6, 2, 8, 5, 6}},
+    {4, {8, 3, 0, 8, 11, 3, 8, 6, 11, 8, 5, 6}},
+    {3, {8, 11, 10, 8, 6, 11, 8, 5, 6}},
+    {4, {8, 5, 4, 2, 7, 6, 2, 10, 7, 2, 0, 10}},
+    {3, {8, 5, 4, 2, 7, 6, 2, 3, 7}},
+    {3, {8, 5, 4, 3, 0, 10, 6, 11, 7}},
+    {2, {8, 5, 4, 7, 6, 11}},
+    {4, {8, 2, 0, 8, 11, 2, 8, 7, 11, 8, 5, 7}},
+    {3, {8, 7, 10, 8, 5, 7, 2, 3, 11}},
+    {3, {8, 3, 0, 8, 7, 3, 8, 5, 7}},
+    {2, {8, 7, 10, 8, 5, 7}},
+    {3, {8, 5, 4, 2, 10, 11, 2, 0, 10}},
+    {6, {8, 2, 3, 11, 2, 5, 4, 3, 11, 2, 8, 5, 4, 8, 3, 11, 5, 4}},
+    {2, {8, 5, 4, 3, 0, 10}},
+    {1, {8, 5, 4}},
+    {2, {9, 4, 6, 9, 8, 4}},
+    {5, {9, 4, 6, 9, 10, 4, 9, 3, 10, 9, 0, 3, 9, 8, 0}},
+    {5, {9, 3, 2, 9, 4, 3, 4, 11, 3, 4, 6, 11, 9, 8, 4}},
+    {4, {9, 0, 2, 9, 8, 0, 6, 10, 4, 6, 11, 10}},
+    {3, {9, 7, 6, 9, 10, 7, 9, 8, 10}},
+    {4, {9, 7, 6, 9, 3, 7, 9, 0, 3, 9, 8, 0}},
+    {4, {9, 3, 2, 9, 10, 3, 9, 8, 10, 7, 6, 11}},
+    {3, {9, 0, 2, 9, 8, 0, 6, 11, 7}},
+    {3, {9, 7, 11, 9, 4, 7, 9, 8, 4}},
+    {4, {9, 3, 11, 9, 0, 3, 9, 8, 0, 4, 7, 10}},
+    {4, {9, 3, 2, 9, 7, 3, 9, 4, 7, 9, 8, 4}},
+    {3, {9, 0, 2, 9, 8, 0, 10, 4, 7}},
+    {2, {9, 10, 11, 9, 8, 10}},
+    {3, {9, 3, 11, 9, 0, 3, 9, 8, 0}},
+    {3, {9, 3, 2, 9, 10, 3, 9, 8, 10}},
+    {2, {9, 0, 2, 9, 8, 0}},
+    {3, {9, 4, 6, 9, 0, 4, 9, 1, 0}},
+    {4, {9, 4, 6, 9, 10, 4, 9, 3, 10, 9, 1, 3}},
+    {4, {9, 1, 2, 3, 6, 11, 3, 4, 6, 3, 0, 4}},
+    {3, {9, 1, 2, 4, 11, 10, 4, 6, 11}},
+    {4, {9, 7, 6, 9, 10, 7, 9, 0, 10, 9, 1, 0}},
+    {3, {9, 7, 6, 9, 3, 7, 9, 1, 3}},
+    {3, {9, 1, 2, 3, 0, 10, 6, 11, 7}},
+    {2, {9, 1, 2, 7, 6, 11}},
+    {4, {9, 7, 11, 9, 4, 7, 9, 0, 4, 9, 1, 0}},
+    {3, {9, 3, 11, 9, 1, 3, 4, 7, 10}},
+    {3, {9, 1, 2, 3, 4, 7, 3, 0, 4}},
+    {6, {9, 4, 7, 10, 4, 1, 2, 7, 10, 4, 9, 1, 2, 9, 7, 10, 1, 2}},
+    {3, {9, 10, 11, 9, 0, 10, 9, 1, 0}},
+    {2, {9, 3, 11, 9, 1, 3}},
+    {2, {9, 1, 2, 3, 0, 10}},
+    {1, {9, 1, 2}},
+    {3, {1, 6, 2, 1, 4, 6, 1, 8, 4}},
+    {4, {1, 8, 0, 2, 4, 6, 2, 10, 4, 2, 3, 10}},
+    {4, {1, 11, 3, 1, 6, 11, 1, 4, 6, 1, 8, 4}},
+    {3, {1, 8, 0, 6, 10, 4, 6, 11, 10}},
+    {4, {1, 6, 2, 1, 7, 6, 1, 10, 7, 1, 8, 10}},
+    {3, {1, 8, 0, 2, 7, 6, 2, 3, 7}},
+    {3, {1, 10, 3, 1, 8, 10, 7, 6, 11}},
+    {6, {1, 6, 11, 7, 6, 8, 0, 11, 7, 6, 1, 8, 0, 1, 11, 7, 8, 0}},
+    {4, {1, 11, 2, 1, 7, 11, 1, 4, 7, 1, 8, 4}},
+    {3, {1, 8, 0, 2, 3, 11, 4, 7, 10}},
+    {3, {1, 7, 3, 1, 4, 7, 1, 8, 4}},
+    {2, {1, 8, 0, 10, 4, 7}},
+    {3, {1, 11, 2, 1, 10, 11, 1, 8, 10}},
+    {2, {1, 8, 0, 2, 3, 11}},
+    {2, {1, 10, 3, 1, 8, 10}},
+    {1, {1, 8, 0}},
+    {2, {0, 6, 2, 0, 4, 6}},
+    {3, {3, 6, 2, 3, 4, 6, 3, 10, 4}},
+    {3, {11, 4, 6, 11, 0, 4, 11, 3, 0}},
+    {2, {11, 4, 6, 11, 10, 4}},
+    {3, {10, 2, 0, 10, 6, 2, 10, 7, 6}},
+    {2, {3, 6, 2, 3, 7, 6}},
+    {2, {10, 3, 0, 7, 6, 11}},
+    {1, {11, 7, 6}},
+    {3, {7, 0, 4, 7, 2, 0, 7, 11, 2}},
+    {2, {7, 10, 4, 2, 3, 11}},
+    {2, {7, 0, 4, 7, 3, 0}},
+    {1, {7, 10, 4}},
+    {2, {10, 2, 0, 10, 11, 2}},
+    {1, {3, 11, 2}},
+    {1, {10, 3, 0}},
+    {0, {}},
+};
+
+// bit e is set when cube edge e is crossed by the surface
+constexpr unsigned short MC_EDGE_MASK[256] = {
+    0x000, 0x409, 0x80c, 0xc05, 0x490, 0x099, 0xc9c, 0x895,
+    0x8c0, 0xcc9, 0x0cc, 0x4c5, 0xc50, 0x859, 0x45c, 0x055,
+    0x103, 0x50a, 0x90f, 0xd06, 0x593, 0x19a, 0xd9f, 0x996,
+    0x9c3, 0xdca, 0x1cf, 0x5c6, 0xd53, 0x95a, 0x55f, 0x156,
+    0x206, 0x60f, 0xa0a, 0xe03, 0x696, 0x29f, 0xe9a, 0xa93,
+    0xac6, 0xecf, 0x2ca, 0x6c3, 0xe56, 0xa5f, 0x65a, 0x253,
+    0x305, 0x70c, 0xb09, 0xf00, 0x795, 0x39c, 0xf99, 0xb90,
+    0xbc5, 0xfcc, 0x3c9, 0x7c0, 0xf55, 0xb5c, 0x759, 0x350,
+    0x130, 0x539, 0x93c, 0xd35, 0x5a0, 0x1a9, 0xdac, 0x9a5,
+    0x9f0, 0xdf9, 0x1fc, 0x5f5, 0xd60, 0x969, 0x56c, 0x165,
+    0x033, 0x43a, 0x83f, 0xc36, 0x4a3, 0x0aa, 0xcaf, 0x8a6,
+    0x8f3, 0xcfa, 0x0ff, 0x4f6, 0xc63, 0x86a, 0x46f, 0x066,
+    0x336, 0x73f, 0xb3a, 0xf33, 0x7a6, 0x3af, 0xfaa, 0xba3,
+    0xbf6, 0xfff, 0x3fa, 0x7f3, 0xf66, 0xb6f, 0x76a, 0x363,
+    0x235, 0x63c, 0xa39, 0xe30, 0x6a5, 0x2ac, 0xea9, 0xaa0,
+    0xaf5, 0xefc, 0x2f9, 0x6f0, 0xe65, 0xa6c, 0x669, 0x260,
+    0x260, 0x669, 0xa6c, 0xe65, 0x6f0, 0x2f9, 0xefc, 0xaf5,
+    0xaa0, 0xea9, 0x2ac, 0x6a5, 0xe30, 0xa39, 0x63c, 0x235,
+    0x363, 0x76a, 0xb6f, 0xf66, 0x7f3, 0x3fa, 0xfff, 0xbf6,
+    0xba3, 0xfaa, 0x3af, 0x7a6, 0xf33, 0xb3a, 0x73f, 0x336,
+    0x066, 0x46f, 0x86a, 0xc63, 0x4f6, 0x0ff, 0xcfa, 0x8f3,
+    0x8a6, 0xcaf, 0x0aa, 0x4a3, 0xc36, 0x83f, 0x43a, 0x033,
+    0x165, 0x56c, 0x969, 0xd60, 0x5f5, 0x1fc, 0xdf9, 0x9f0,
+    0x9a5, 0xdac, 0x1a9, 0x5a0, 0xd35, 0x93c, 0x539, 0x130,
+    0x350, 0x759, 0xb5c, 0xf55, 0x7c0, 0x3c9, 0xfcc, 0xbc5,
+    0xb90, 0xf99, 0x39c, 0x795, 0xf00, 0xb09, 0x70c, 0x305,
+    0x253, 0x65a, 0xa5f, 0xe56, 0x6c3, 0x2ca, 0xecf, 0xac6,
+    0xa93, 0xe9a, 0x29f, 0x696, 0xe03, 0xa0a, 0x60f, 0x206,
+    0x156, 0x55f, 0x95a, 0xd53, 0x5c6, 0x1cf, 0xdca, 0x9c3,
+    0x996, 0xd9f, 0x19a, 0x593, 0xd06, 0x90f, 0x50a, 0x103,
+    0x055, 0x45c, 0x859, 0xc50, 0x4c5, 0x0cc, 0xcc9, 0x8c0,
+    0x895, 0xc9c, 0x099, 0x490, 0xc05, 0x80c, 0x409, 0x000,
+};
+#define _TAULAMC_HPP_
+#endif
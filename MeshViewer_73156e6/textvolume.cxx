@@ -0,0 +1,208 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#include "textvolume.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <locale.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "volume.h"
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+static inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// converts the number in [begin, end), giving the same float as operator>>. Decimal numbers
+// with a mantissa up to 2^53 and small exponents are rounded exactly in double arithmetic,
+// and rounding that double to float is only wrong when it lies right between two floats.
+// Anything else goes through the standard library.
+static bool parseFloat(const char *begin, const char *end, float &value) {
+    static const double powers_of_10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char *p = begin;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    uint64_t mantissa = 0;
+    int significant_digits = 0, n_digits = 0, exponent = 0;
+    for (; p < end && isDigit(*p); p++, n_digits++) {
+        mantissa = mantissa * 10 + (*p - '0');
+        significant_digits += mantissa != 0;
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && isDigit(*p); p++, n_digits++) {
+            mantissa = mantissa * 10 + (*p - '0');
+            significant_digits += mantissa != 0;
+            exponent--;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E') && n_digits > 0) {
+        p++;
+        bool negative_exponent = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative_exponent = *p++ == '-';
+        int e = 0;
+        for (; p < end && isDigit(*p); p++)
+            e = std::min(e * 10 + (*p - '0'), 100000);
+        exponent += negative_exponent ? -e : e;
+    }
+
+    if (p == end && n_digits > 0 && significant_digits <= 19) {
+        if (mantissa == 0) {
+            value = negative ? -0.f : 0.f;
+            return true;
+        }
+        if (mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+            double v = exponent < 0 ? mantissa / powers_of_10[-exponent] : mantissa * powers_of_10[exponent];
+            // in the range of normal floats, a double lies between two floats when the 29 bits
+            // of its mantissa that a float does not have are 1 followed by zeros
+            uint64_t bits;
+            std::memcpy(&bits, &v, sizeof(bits));
+            if (v >= FLT_MIN && v <= FLT_MAX && (bits & 0x1fffffff) != 0x10000000) {
+                value = negative ? -(float) v : (float) v;
+                return true;
+            }
+        }
+    }
+
+    // strtof in the "C" locale, whatever the locale of the application is
+    static locale_t c_locale = newlocale(LC_ALL_MASK, "C", (locale_t) 0);
+    std::string token(begin, end);
+    char *parsed_end;
+    value = strtof_l(token.c_str(), &parsed_end, c_locale);
+    return parsed_end == token.c_str() + token.size();
+}
+
+// start of each of the n_chunks chunks of [begin, end), moved forward to a whitespace
+static std::vector<const char *> splitChunks(const char *begin, const char *end, int n_chunks) {
+    std::vector<const char *> bounds(n_chunks + 1, end);
+    bounds[0] = begin;
+    for (int c = 1; c < n_chunks; c++) {
+        const char *p = std::max(bounds[c - 1], begin + (end - begin) * c / n_chunks);
+        while (p < end && !isSpace(*p))
+            p++;
+        bounds[c] = p;
+    }
+    return bounds;
+}
+
+static size_t countTokens(const char *p, const char *end) {
+    size_t n = 0;
+    bool in_token = false;
+    for (; p < end; p++) {
+        bool space = isSpace(*p);
+        n += in_token && space;
+        in_token = !space;
+    }
+    return n + in_token;
+}
+
+static bool parseTokens(const char *p, const char *end, float *samples, float &min_value, float &max_value) {
+    float lo = INFINITY, hi = -INFINITY;
+    while (true) {
+        while (p < end && isSpace(*p))
+            p++;
+        if (p == end)
+            break;
+        const char *token = p;
+        while (p < end && !isSpace(*p))
+            p++;
+        if (!parseFloat(token, p, *samples)) {
+            std::cerr << "Invalid sample " << std::string(token, p) << std::endl;
+            return false;
+        }
+        lo = std::min(lo, *samples);
+        hi = std::max(hi, *samples);
+        samples++;
+    }
+    min_value = lo;
+    max_value = hi;
+    return true;
+}
+
+bool readTextVolume(const char *name, Grid &grid, std::vector<float> &samples,
+                    float &min_value, float &max_value, int num_threads) {
+    MappedFile file;
+    if (!file.open(name))
+        return false;
+
+    const char *begin = file.data(), *end = file.data() + file.size();
+    const char *body = std::find(begin, end, '\n');
+    std::istringstream header(std::string(begin, body));
+    if (!grid.readHeader(header))
+        return false;
+
+    // chunks of at least 1 MB, so small volumes are not split
+    int n_chunks = num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+    n_chunks = std::max<long long>(1, std::min<long long>(n_chunks, (end - body) >> 20));
+    std::vector<const char *> bounds = splitChunks(body, end, n_chunks);
+
+    // count the samples of each chunk first, so that all of them are parsed in place
+    std::vector<size_t> offsets(n_chunks + 1, 0);
+    std::vector<float> chunk_min(n_chunks), chunk_max(n_chunks);
+    std::vector<char> chunk_ok(n_chunks);
+    std::vector<std::thread> workers;
+    for (int c = 1; c < n_chunks; c++)
+        workers.emplace_back([&, c]() {offsets[c + 1] = countTokens(bounds[c], bounds[c + 1]);});
+    offsets[1] = countTokens(bounds[0], bounds[1]);
+    for (std::thread &w : workers)
+        w.join();
+    workers.clear();
+    for (int c = 0; c < n_chunks; c++)
+        offsets[c + 1] += offsets[c];
+
+    if (offsets[n_chunks] != grid.n_samples()) {
+        std::cerr << "Volume " << name << " has " << offsets[n_chunks] << " samples instead of "
+                  << grid.n_samples() << std::endl;
+        return false;
+    }
+
+    samples.resize(grid.n_samples());
+    auto parseChunk = [&](int c) {
+        chunk_ok[c] = parseTokens(bounds[c], bounds[c + 1], samples.data() + offsets[c], chunk_min[c], chunk_max[c]);
+    };
+    for (int c = 1; c < n_chunks; c++)
+        workers.emplace_back(parseChunk, c);
+    parseChunk(0);
+    for (std::thread &w : workers)
+        w.join();
+
+    min_value = INFINITY;
+    max_value = -INFINITY;
+    for (int c = 0; c < n_chunks; c++) {
+        if (!chunk_ok[c])
+            return false;
+        min_value = std::min(min_value, chunk_min[c]);
+        max_value = std::max(max_value, chunk_max[c]);
+    }
+    return true;
+}
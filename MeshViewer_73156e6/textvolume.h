@@ -0,0 +1,32 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#ifndef __MeshViewer_textvolume_h_
+#define __MeshViewer_textvolume_h_
+#include <vector>
+#include "grid.h"
+
+// Reads a text volume file: the header line (see Grid::readHeader) followed by the samples,
+// separated by whitespace. The file is mapped in memory and split in chunks that are parsed
+// on num_threads threads (0 = one per hardware thread), computing the range of values in the
+// same pass.
+bool readTextVolume(const char *name, Grid &grid, std::vector<float> &samples,
+                    float &min_value, float &max_value, int num_threads = 0);
+
+#endif // __MeshViewer_textvolume_h_
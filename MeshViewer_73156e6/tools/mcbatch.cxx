@@ -0,0 +1,220 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+//
+// Extracts isosurfaces of a volume without the viewer (no display needed) and writes them as
+// mesh files:
+//
+//   mcbatch volume isovalues [threads] [format] [stats]
+//
+// where isovalues is a single isovalue or a range first:last:step, threads the number of worker
+// threads (0, the default, for one per hardware thread) and format the extension of the files
+// written: obj (default) or any other format OpenMesh writes, such as off, ply, stl or om. The
+// surface of each isovalue is written to <volume name>_<isovalue>.<format> in the current
+// directory. All the isovalues of a range are extracted in a single pass over the volume. If
+// a stats file is given, the time spent in each stage of the extraction and its counters are
+// written to it as JSON.
+//
+//   mcbatch --stream volume isovalues
+//
+// extracts the surfaces with a StreamingExtractor instead, which reads the volume one slice at
+// a time and writes the triangles to the OBJ file as they are found, so volumes larger than
+// the memory can be processed. Each isovalue takes a pass over the file.
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <OpenMesh/Tools/Utils/Timer.hh>
+#include "scene.h"
+#include "streaming.h"
+
+// mesh written to the files. The writers of OpenMesh can not convert the float colors of MyMesh,
+// and the files only need the positions and normals.
+struct OutputTraits : public OpenMesh::DefaultTraits
+{
+  VertexAttributes(OpenMesh::Attributes::Normal);
+};
+typedef OpenMesh::TriMesh_ArrayKernelT<OutputTraits> OutputMesh;
+
+static void buildOutputMesh(const IsoSurface &surface, OutputMesh &m)
+{
+  m.reserve(surface.n_vertices(), surface.n_vertices() + surface.n_triangles(), surface.n_triangles());
+  for (size_t v = 0; v < surface.positions.size(); v += 3) {
+    OutputMesh::VertexHandle vh = m.add_vertex(OutputMesh::Point(&surface.positions[v]));
+    m.set_normal(vh, OutputMesh::Normal(&surface.normals[v]));
+  }
+  for (size_t t = 0; t < surface.indices.size(); t += 3)
+    m.add_face(OutputMesh::VertexHandle(surface.indices[t]), OutputMesh::VertexHandle(surface.indices[t + 1]),
+               OutputMesh::VertexHandle(surface.indices[t + 2]));
+}
+
+// isovalues given as "value" or "first:last:step"
+static bool parseIsovalues(const std::string &arg, std::vector<float> &isovalues)
+{
+  std::istringstream in(arg);
+  float first, last, step;
+  char separator_0, separator_1;
+  if (!(in >> first))
+    return false;
+  if (in.eof()) {
+    isovalues.push_back(first);
+    return true;
+  }
+  if (!(in >> separator_0 >> last >> separator_1 >> step) || !in.eof() ||
+      separator_0 != ':' || separator_1 != ':' || step <= 0.f || last < first)
+    return false;
+
+  // the last isovalue is included if the range is a multiple of the step, up to rounding
+  int n = int(std::floor((last - first) / step + 1e-3f)) + 1;
+  for (int s = 0; s < n; s++)
+    isovalues.push_back(first + s * step);
+  return true;
+}
+
+// name of the file without its directory and extension
+static std::string baseName(const std::string &path)
+{
+  std::string name = path.substr(path.find_last_of('/') + 1);
+  return name.substr(0, name.find_last_of('.'));
+}
+
+// writes the surface of each isovalue as it is extracted, without loading the volume
+static int streamIsosurfaces(const char *volume_name, const std::vector<float> &isovalues)
+{
+  OpenMesh::Utils::Timer timer;
+  double extraction_time = 0.;
+  size_t n_triangles = 0;
+  for (float isovalue : isovalues) {
+    std::ostringstream file_name;
+    file_name << baseName(volume_name) << "_" << isovalue << ".obj";
+    std::ofstream out(file_name.str());
+    ObjWriter writer(out);
+    StreamingExtractor extractor(isovalue);
+    timer.start();
+    bool extracted = extractor.extract(volume_name, writer);
+    out.close();
+    timer.stop();
+    extraction_time += timer.seconds();
+    if (!extracted)
+      return 1;
+    if (!out) {
+      std::cerr << "Error writing " << file_name.str() << std::endl;
+      return 1;
+    }
+    n_triangles += extractor.n_triangles();
+    std::cout << "isovalue " << isovalue << ": " << extractor.n_vertices() << " vertices, "
+              << extractor.n_triangles() << " triangles -> " << file_name.str() << std::endl;
+  }
+  std::cout << "streaming extraction: " << extraction_time << " s, "
+            << n_triangles / extraction_time / 1e6 << " M triangles/s" << std::endl;
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<float> isovalues;
+  if (argc > 1 && std::strcmp(argv[1], "--stream") == 0) {
+    if (argc != 4 || !parseIsovalues(argv[3], isovalues)) {
+      std::cerr << "usage: " << argv[0] << " --stream <volume> <isovalue | first:last:step>" << std::endl;
+      return 1;
+    }
+    return streamIsosurfaces(argv[2], isovalues);
+  }
+
+  int threads = argc > 3 ? std::atoi(argv[3]) : 0;
+  std::string format = argc > 4 ? argv[4] : "obj";
+  const char *stats_file = argc > 5 ? argv[5] : nullptr;
+  if (argc < 3 || argc > 6 || !parseIsovalues(argv[2], isovalues) || threads < 0 ||
+      !OpenMesh::IO::IOManager().can_write(format)) {
+    std::cerr << "usage: " << argv[0] << " <volume> <isovalue | first:last:step> [threads] [obj|off|ply|stl|om] [stats.json]" << std::endl
+              << "       " << argv[0] << " --stream <volume> <isovalue | first:last:step>" << std::endl;
+    return 1;
+  }
+
+  Scene scene;
+  scene.setNumThreads(threads);
+  scene.setOutputMode(Scene::FLAT_BUFFERS);
+  scene.setCollectStats(stats_file != nullptr);
+
+  // the volume is read once, the extraction then finds it in the cache
+  OpenMesh::Utils::Timer timer;
+  timer.start();
+  std::shared_ptr<const LoadedVolume> volume = scene.volumeCache().acquire(argv[1], threads);
+  timer.stop();
+  if (!volume)
+    return 1;
+  double load_time = timer.seconds();
+  const Grid &grid = volume->grid;
+  std::cout << argv[1] << ": " << grid.dims[0] << "x" << grid.dims[1] << "x" << grid.dims[2] << " "
+            << volumeTypeName(volume->type) << " samples in [" << volume->min_value << ", "
+            << volume->max_value << "], read in " << load_time << " s" << std::endl;
+
+  timer.start();
+  bool extracted;
+  if (isovalues.size() == 1) {
+    scene.setIsovalue(isovalues[0]);
+    extracted = scene.computeVolumeIsosurface(argv[1]);
+  } else {
+    extracted = scene.computeVolumeIsosurfaces(argv[1], isovalues);
+  }
+  timer.stop();
+  double extraction_time = timer.seconds();
+  if (!extracted && isovalues.size() > 1)
+    return 1;
+
+  // an empty surface is reported, but not written
+  size_t n_triangles = 0;
+  double write_time = 0.;
+  for (size_t l = 0; l < isovalues.size(); l++) {
+    const IsoSurface *surface = extracted ? &scene.surfaces()[l] : nullptr;
+    if (!surface || surface->n_triangles() == 0) {
+      std::cout << "isovalue " << isovalues[l] << ": empty" << std::endl;
+      continue;
+    }
+    n_triangles += surface->n_triangles();
+
+    std::ostringstream file_name;
+    file_name << baseName(argv[1]) << "_" << isovalues[l] << "." << format;
+    timer.start();
+    OutputMesh m;
+    buildOutputMesh(*surface, m);
+    bool written = OpenMesh::IO::write_mesh(m, file_name.str(), OpenMesh::IO::Options::VertexNormal);
+    timer.stop();
+    write_time += timer.seconds();
+    if (!written) {
+      std::cerr << "Error writing " << file_name.str() << std::endl;
+      return 1;
+    }
+    std::cout << "isovalue " << isovalues[l] << ": " << surface->n_vertices() << " vertices, "
+              << surface->n_triangles() << " triangles -> " << file_name.str() << std::endl;
+  }
+
+  double n_cells = double(grid.dims[0] - 1) * (grid.dims[1] - 1) * (grid.dims[2] - 1) * isovalues.size();
+  std::cout << "extraction: " << extraction_time << " s, " << n_cells / extraction_time / 1e6 << " M cells/s, "
+            << n_triangles / extraction_time / 1e6 << " M triangles/s" << std::endl;
+  std::cout << "writing: " << write_time << " s" << std::endl;
+  if (stats_file && !scene.stats().writeJson(stats_file))
+    return 1;
+  return 0;
+}
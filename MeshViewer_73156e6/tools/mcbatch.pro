@@ -0,0 +1,23 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt
+CONFIG += warn_on
+CONFIG += thread
+QMAKE_CXXFLAGS += -std=c++14 -D__USE_XOPEN
+
+# Inputs:
+INCLUDEPATH += ..
+INCLUDEPATH += ../../glm
+
+HEADERS += ../bricks.h ../classify.h ../decider.h ../grid.h ../octree.h ../scalar.h ../scene.h ../spanspace.h ../stats.h \
+           ../streaming.h ../taulaMC.hpp ../textvolume.h ../utils.h ../volume.h ../volumecache.h
+SOURCES += mcbatch.cxx ../bricks.cxx ../classify.cxx ../decider.cxx ../grid.cxx ../octree.cxx ../scene.cxx ../spanspace.cxx ../stats.cxx \
+           ../streaming.cxx ../textvolume.cxx ../utils.cxx ../volume.cxx ../volumecache.cxx
+
+LIBS += -L/usr/local/lib -lOpenMeshCore -lOpenMeshTools
+
+# Outputs:
+TARGET = mcbatch
+# each tool of this directory has its own makefile and objects, built with its own flags
+MAKEFILE = Makefile.mcbatch
+OBJECTS_DIR = build/mcbatch
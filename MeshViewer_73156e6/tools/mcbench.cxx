@@ -0,0 +1,362 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+//
+// Benchmark of the marching cubes extraction, built on Google Benchmark like the OpenMesh
+// benchmarks. Each volume is measured in six stages:
+//
+//   MC_Load         reading the volume and building its bricks and span space
+//   MC_Classify     case of every cell of the volume (single-threaded classification kernel)
+//   MC_Triangulate  extraction of the isosurface, without normals
+//   MC_Decider      the same with the ambiguous faces resolved (Scene::ASYMPTOTIC_DECIDER)
+//   MC_Adaptive     octree dual contouring with the default tolerance (Scene::ADAPTIVE_DUAL_CONTOURING)
+//   MC_Normals      vertex normals averaged from the triangles
+//
+// each one reporting the cells and triangles of the volume processed per second. The volumes
+// are analytic fields (sphere, torus, noise, gyroid) of 64^3 samples and up, extracted at
+// isovalue 0, and the text volumes of the Data folder, extracted at isovalue 0 as well:
+//
+//   mcbench [--mc_max_size=256] [--mc_data=../../Data] [--mc_threads=0] [benchmark options]
+//
+// Fields are generated up to --mc_max_size samples per axis (at most 1024), and written as
+// float32 binary volumes to $TMPDIR (or /tmp) the first time they are used, then removed on
+// exit. Extraction uses --mc_threads worker threads (0 for one per hardware thread). The
+// options of Google Benchmark, such as --benchmark_filter=gyroid, select and repeat the runs.
+
+#include <dirent.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "classify.h"
+#include "scene.h"
+#include "volume.h"
+#include "volumecache.h"
+
+struct BenchVolume {
+  std::string name;  // as shown in the benchmark names
+  std::string field; // analytic field, or empty for a volume file
+  int size;          // samples per axis of the field
+  std::string file;  // volume file, generated on first use for the fields
+};
+
+static int num_threads = 0;
+static std::map<std::string, std::string> generated_files;
+static std::map<std::string, size_t> triangle_counts; // by volume and extraction method
+
+// pseudo-random value in [-1, 1] at an integer lattice point
+static float latticeValue(int x, int y, int z)
+{
+  uint32_t h = uint32_t(x) * 73856093u ^ uint32_t(y) * 19349663u ^ uint32_t(z) * 83492791u;
+  h ^= h >> 13;
+  h *= 0x5bd1e995u;
+  h ^= h >> 15;
+  return h * (2.f / 4294967295.f) - 1.f;
+}
+
+// lattice values interpolated with smoothstep weights
+static float valueNoise(float x, float y, float z)
+{
+  int x0 = int(std::floor(x)), y0 = int(std::floor(y)), z0 = int(std::floor(z));
+  float u = x - x0, v = y - y0, w = z - z0;
+  u = u * u * (3.f - 2.f * u);
+  v = v * v * (3.f - 2.f * v);
+  w = w * w * (3.f - 2.f * w);
+  float value = 0.f;
+  for (int c = 0; c < 8; c++) {
+    int dx = c >> 2, dy = (c >> 1) & 1, dz = c & 1;
+    value += latticeValue(x0 + dx, y0 + dy, z0 + dz) * (dx ? u : 1.f - u) * (dy ? v : 1.f - v) * (dz ? w : 1.f - w);
+  }
+  return value;
+}
+
+// value of a field at a point of [-1, 1]^3, the surface being at 0
+static float fieldValue(const std::string &field, float x, float y, float z)
+{
+  if (field == "sphere")
+    return std::sqrt(x * x + y * y + z * z) - 0.6f;
+  if (field == "torus") {
+    float ring = std::sqrt(x * x + y * y) - 0.6f;
+    return std::sqrt(ring * ring + z * z) - 0.25f;
+  }
+  if (field == "noise") {
+    // three octaves, 4 to 16 cells of the lattice across the volume
+    float value = 0.f, amplitude = 1.f, frequency = 2.f;
+    for (int octave = 0; octave < 3; octave++) {
+      value += amplitude * valueNoise((x + 1.f) * frequency, (y + 1.f) * frequency, (z + 1.f) * frequency);
+      amplitude *= 0.5f;
+      frequency *= 2.f;
+    }
+    return value;
+  }
+  // gyroid, with 4 periods across the volume
+  const float f = 4.f * float(M_PI);
+  return std::sin(f * x) * std::cos(f * y) + std::sin(f * y) * std::cos(f * z) + std::sin(f * z) * std::cos(f * x);
+}
+
+// file of the volume, generating the samples of a field on first use
+static std::string volumeFile(const BenchVolume &volume)
+{
+  if (volume.field.empty())
+    return volume.file;
+  std::map<std::string, std::string>::iterator generated = generated_files.find(volume.name);
+  if (generated != generated_files.end())
+    return generated->second;
+
+  Grid grid;
+  int n = volume.size;
+  for (int axis = 0; axis < 3; axis++) {
+    grid.dims[axis] = n;
+    grid.spacing[axis] = 2.f / (n - 1);
+    grid.origin[axis] = -1.f;
+  }
+  std::vector<float> samples(grid.n_samples());
+  auto generate = [&](int i_begin, int i_end) {
+    for (int i = i_begin; i < i_end; i++)
+      for (int j = 0; j < n; j++)
+        for (int k = 0; k < n; k++)
+          samples[grid.index(i, j, k)] = fieldValue(volume.field, grid.origin[0] + i * grid.spacing[0],
+                                                    grid.origin[1] + j * grid.spacing[1],
+                                                    grid.origin[2] + k * grid.spacing[2]);
+  };
+  int n_threads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::thread> workers;
+  for (int t = 0; t < n_threads; t++)
+    workers.emplace_back(generate, n * t / n_threads, n * (t + 1) / n_threads);
+  for (std::thread &w : workers)
+    w.join();
+
+  const char *directory = std::getenv("TMPDIR");
+  std::string file = std::string(directory ? directory : "/tmp") + "/mcbench_" + volume.field + "_" +
+                     std::to_string(n) + ".vol";
+  std::pair<std::vector<float>::iterator, std::vector<float>::iterator> range =
+      std::minmax_element(samples.begin(), samples.end());
+  if (!writeVolume(file.c_str(), grid, VOLUME_FLOAT32, samples.data(), *range.first, *range.second))
+    return "";
+  generated_files[volume.name] = file;
+  return file;
+}
+
+// scene extracting the isosurface from scratch each time, without normals
+static void setupScene(Scene &scene)
+{
+  scene.setNumThreads(num_threads);
+  scene.setOutputMode(Scene::FLAT_BUFFERS);
+  scene.setNormalMode(Scene::NO_NORMALS);
+  scene.setIncrementalUpdates(false);
+  // the new isovalue is reported on std::cout, where it would break the table of results
+  std::streambuf *out = std::cout.rdbuf(nullptr);
+  scene.setIsovalue(0.f);
+  std::cout.rdbuf(out);
+}
+
+// cells of the volume and triangles of its isosurface extracted with the given method, as
+// rates of each iteration
+static bool setRates(benchmark::State &state, const BenchVolume &volume,
+                     Scene::ExtractionMethod method = Scene::MARCHING_CUBES)
+{
+  std::string file = volumeFile(volume);
+  std::string key = volume.name + "/" + std::to_string(method);
+  std::map<std::string, size_t>::iterator triangles = triangle_counts.find(key);
+  if (triangles == triangle_counts.end()) {
+    Scene scene;
+    setupScene(scene);
+    scene.setExtractionMethod(method);
+    size_t n_triangles = scene.computeVolumeIsosurface(file.c_str()) ? scene.surfaces()[0].n_triangles() : 0;
+    triangles = triangle_counts.insert(std::make_pair(key, n_triangles)).first;
+  }
+  VolumeCache cache;
+  std::shared_ptr<const LoadedVolume> loaded = cache.acquire(file.c_str(), num_threads);
+  if (!loaded || triangles->second == 0) {
+    state.SkipWithError(loaded ? "empty isosurface" : "volume not loaded");
+    return false;
+  }
+
+  const Grid &grid = loaded->grid;
+  double n_cells = double(grid.dims[0] - 1) * (grid.dims[1] - 1) * (grid.dims[2] - 1);
+  state.counters["cells"] = benchmark::Counter(n_cells, benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["triangles"] = benchmark::Counter(triangles->second, benchmark::Counter::kIsIterationInvariantRate);
+  return true;
+}
+
+static void MC_Load(benchmark::State &state, const BenchVolume &volume)
+{
+  if (!setRates(state, volume))
+    return;
+  std::string file = volumeFile(volume);
+  while (state.KeepRunning()) {
+    VolumeCache cache;
+    std::shared_ptr<const LoadedVolume> loaded = cache.acquire(file.c_str(), num_threads);
+    benchmark::DoNotOptimize(loaded.get());
+  }
+}
+
+template <typename T>
+static size_t classifyVolume(const LoadedVolume &volume, float isovalue, std::vector<unsigned char> &cases,
+                             std::vector<int> &active)
+{
+  const Grid &grid = volume.grid;
+  const int Nj = grid.dims[1], Nk = grid.dims[2];
+  size_t n_active = 0;
+  for (int i = 0; i < grid.dims[0] - 1; i++) {
+    for (int j = 0; j < Nj - 1; j++) {
+      const T *row = (const T *) volume.data + grid.index(i, j, 0);
+      n_active += classifyRow(row, row + Nk, row + Nj * Nk, row + Nj * Nk + Nk, Nk - 1, isovalue,
+                              cases.data(), active.data());
+    }
+  }
+  return n_active;
+}
+
+static void MC_Classify(benchmark::State &state, const BenchVolume &volume)
+{
+  if (!setRates(state, volume))
+    return;
+  VolumeCache cache;
+  std::shared_ptr<const LoadedVolume> loaded = cache.acquire(volumeFile(volume).c_str(), num_threads);
+  std::vector<unsigned char> cases(loaded->grid.dims[2]);
+  std::vector<int> active(loaded->grid.dims[2]);
+  size_t n_active = 0;
+  while (state.KeepRunning()) {
+    switch (loaded->type) {
+    case VOLUME_FLOAT16: n_active = classifyVolume<half>(*loaded, 0.f, cases, active); break;
+    case VOLUME_UINT8:   n_active = classifyVolume<uint8_t>(*loaded, 0.f, cases, active); break;
+    case VOLUME_UINT16:  n_active = classifyVolume<uint16_t>(*loaded, 0.f, cases, active); break;
+    case VOLUME_INT16:   n_active = classifyVolume<int16_t>(*loaded, 0.f, cases, active); break;
+    default:             n_active = classifyVolume<float>(*loaded, 0.f, cases, active); break;
+    }
+    benchmark::DoNotOptimize(n_active);
+  }
+  state.counters["active"] = n_active;
+  state.SetLabel(classifyKernelName());
+}
+
+static void extract(benchmark::State &state, const BenchVolume &volume, Scene::ExtractionMethod method)
+{
+  if (!setRates(state, volume, method))
+    return;
+  std::string file = volumeFile(volume);
+  Scene scene;
+  setupScene(scene);
+  scene.setExtractionMethod(method);
+  scene.computeVolumeIsosurface(file.c_str());
+  while (state.KeepRunning()) {
+    scene.clear_meshes();
+    scene.computeVolumeIsosurface(file.c_str());
+  }
+}
+
+static void MC_Triangulate(benchmark::State &state, const BenchVolume &volume)
+{
+  extract(state, volume, Scene::MARCHING_CUBES);
+}
+
+static void MC_Decider(benchmark::State &state, const BenchVolume &volume)
+{
+  extract(state, volume, Scene::ASYMPTOTIC_DECIDER);
+}
+
+static void MC_Adaptive(benchmark::State &state, const BenchVolume &volume)
+{
+  extract(state, volume, Scene::ADAPTIVE_DUAL_CONTOURING);
+}
+
+static void MC_Normals(benchmark::State &state, const BenchVolume &volume)
+{
+  if (!setRates(state, volume))
+    return;
+  Scene scene;
+  setupScene(scene);
+  scene.computeVolumeIsosurface(volumeFile(volume).c_str());
+  IsoSurface surface = scene.surfaces()[0];
+  while (state.KeepRunning()) {
+    Scene::computeNormals(surface);
+    benchmark::DoNotOptimize(surface.normals.data());
+  }
+}
+
+// text volumes of a directory, by name
+static std::vector<std::string> textVolumes(const std::string &directory)
+{
+  std::vector<std::string> names;
+  DIR *dir = opendir(directory.c_str());
+  if (!dir)
+    return names;
+  while (dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0)
+      names.push_back(name.substr(0, name.size() - 4));
+  }
+  closedir(dir);
+  std::sort(names.begin(), names.end());
+  return names;
+}
+
+int main(int argc, char **argv)
+{
+  // options of this benchmark, the others are left to Google Benchmark
+  int max_size = 256;
+  std::string data_directory = "../../Data";
+  std::vector<char *> args;
+  for (int a = 0; a < argc; a++) {
+    std::string arg = argv[a];
+    if (arg.compare(0, 14, "--mc_max_size=") == 0)
+      max_size = std::atoi(arg.c_str() + 14);
+    else if (arg.compare(0, 10, "--mc_data=") == 0)
+      data_directory = arg.substr(10);
+    else if (arg.compare(0, 13, "--mc_threads=") == 0)
+      num_threads = std::max(0, std::atoi(arg.c_str() + 13));
+    else
+      args.push_back(argv[a]);
+  }
+
+  std::vector<BenchVolume> volumes;
+  const char *fields[] = {"sphere", "torus", "noise", "gyroid"};
+  for (int size = 64; size <= std::min(max_size, 1024); size *= 2)
+    for (const char *field : fields)
+      volumes.push_back(BenchVolume{std::string(field) + "/" + std::to_string(size), field, size, ""});
+  for (const std::string &name : textVolumes(data_directory))
+    volumes.push_back(BenchVolume{"Data/" + name, "", 0, data_directory + "/" + name + ".txt"});
+
+  for (const BenchVolume &volume : volumes) {
+    benchmark::RegisterBenchmark(("MC_Load/" + volume.name).c_str(), MC_Load, volume)->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(("MC_Classify/" + volume.name).c_str(), MC_Classify, volume)->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(("MC_Triangulate/" + volume.name).c_str(), MC_Triangulate, volume)->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(("MC_Decider/" + volume.name).c_str(), MC_Decider, volume)->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(("MC_Adaptive/" + volume.name).c_str(), MC_Adaptive, volume)->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(("MC_Normals/" + volume.name).c_str(), MC_Normals, volume)->Unit(benchmark::kMillisecond);
+  }
+
+  int n_args = args.size();
+  benchmark::Initialize(&n_args, args.data());
+  if (benchmark::ReportUnrecognizedArguments(n_args, args.data()))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  for (const std::pair<const std::string, std::string> &generated : generated_files)
+    std::remove(generated.second.c_str());
+  return 0;
+}
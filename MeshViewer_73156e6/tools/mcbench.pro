@@ -0,0 +1,24 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt
+CONFIG += warn_on
+CONFIG += thread
+CONFIG += release
+QMAKE_CXXFLAGS += -std=c++14 -D__USE_XOPEN
+
+# Inputs:
+INCLUDEPATH += ..
+INCLUDEPATH += ../../glm
+
+HEADERS += ../bricks.h ../classify.h ../decider.h ../grid.h ../octree.h ../scalar.h ../scene.h ../spanspace.h ../stats.h \
+           ../taulaMC.hpp ../textvolume.h ../utils.h ../volume.h ../volumecache.h
+SOURCES += mcbench.cxx ../bricks.cxx ../classify.cxx ../decider.cxx ../grid.cxx ../octree.cxx ../scene.cxx ../spanspace.cxx ../stats.cxx \
+           ../textvolume.cxx ../utils.cxx ../volume.cxx ../volumecache.cxx
+
+LIBS += -L/usr/local/lib -lbenchmark -lOpenMeshCore
+
+# Outputs:
+TARGET = mcbench
+# each tool of this directory has its own makefile and objects, built with its own flags
+MAKEFILE = Makefile.mcbench
+OBJECTS_DIR = build/mcbench
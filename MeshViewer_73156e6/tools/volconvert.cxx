@@ -0,0 +1,89 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+//
+// Converts a text volume file to the binary format, which the viewer maps in memory instead of
+// parsing:
+//
+//   volconvert volume.txt volume.vol [type]
+//
+// where type is the type the samples are stored as: float32 (default), float16, uint8, uint16
+// or int16. Values are rounded to the nearest value of the type and clamped to its range.
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "grid.h"
+#include "textvolume.h"
+#include "volume.h"
+
+// converts the samples to type T, updating the range to the converted values
+template <typename T>
+static void convert(const std::vector<float> &samples, std::vector<char> &converted, float &min_value, float &max_value)
+{
+  converted.resize(samples.size() * sizeof(T));
+  T *out = (T *) converted.data();
+  min_value = INFINITY;
+  max_value = -INFINITY;
+  for (size_t s = 0; s < samples.size(); s++) {
+    out[s] = fromFloat<T>(samples[s]);
+    min_value = std::min(min_value, toFloat(out[s]));
+    max_value = std::max(max_value, toFloat(out[s]));
+  }
+}
+
+int main(int argc, char **argv)
+{
+  VolumeType type = VOLUME_FLOAT32;
+  if (argc == 4) {
+    for (int t = 0; t < VOLUME_TYPE_COUNT; t++)
+      if (std::string(argv[3]) == volumeTypeName(VolumeType(t)))
+        type = VolumeType(t);
+  }
+  if (argc < 3 || argc > 4 || (argc == 4 && std::string(argv[3]) != volumeTypeName(type))) {
+    std::cerr << "usage: " << argv[0] << " <volume.txt> <volume.vol> [float32|float16|uint8|uint16|int16]" << std::endl;
+    return 1;
+  }
+
+  Grid grid;
+  std::vector<float> samples;
+  float min_value, max_value;
+  if (!readTextVolume(argv[1], grid, samples, min_value, max_value)) {
+    std::cerr << "Error reading volume " << argv[1] << std::endl;
+    return 1;
+  }
+
+  std::vector<char> converted;
+  switch (type) {
+  case VOLUME_FLOAT16: convert<half>(samples, converted, min_value, max_value); break;
+  case VOLUME_UINT8:   convert<uint8_t>(samples, converted, min_value, max_value); break;
+  case VOLUME_UINT16:  convert<uint16_t>(samples, converted, min_value, max_value); break;
+  case VOLUME_INT16:   convert<int16_t>(samples, converted, min_value, max_value); break;
+  default:             convert<float>(samples, converted, min_value, max_value); break;
+  }
+
+  if (!writeVolume(argv[2], grid, type, converted.data(), min_value, max_value))
+    return 1;
+
+  std::cout << argv[2] << ": " << grid.dims[0] << "x" << grid.dims[1] << "x" << grid.dims[2]
+            << " " << volumeTypeName(type) << " samples in [" << min_value << ", " << max_value << "]" << std::endl;
+  return 0;
+}
@@ -0,0 +1,18 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt
+CONFIG += warn_on
+CONFIG += thread
+QMAKE_CXXFLAGS += -std=c++14
+
+# Inputs:
+INCLUDEPATH += ..
+
+HEADERS += ../grid.h ../scalar.h ../textvolume.h ../volume.h
+SOURCES += volconvert.cxx ../grid.cxx ../textvolume.cxx ../volume.cxx
+
+# Outputs:
+TARGET = volconvert
+# each tool of this directory has its own makefile and objects, built with its own flags
+MAKEFILE = Makefile.volconvert
+OBJECTS_DIR = build/volconvert
@@ -0,0 +1,134 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#include "volume.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(VolumeHeader) == 64, "the samples of a binary volume start at byte 64");
+
+bool MappedVolume::isBinary(const char *name) {
+    char magic[8] = {};
+    std::ifstream file(name, std::ios::binary);
+    file.read(magic, sizeof(magic));
+    return file && std::memcmp(magic, VOLUME_MAGIC, sizeof(magic)) == 0;
+}
+
+bool MappedFile::open(const char *name) {
+    close();
+
+    int fd = ::open(name, O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error opening " << name << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        length = st.st_size;
+        mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+            mapping = nullptr;
+    }
+    ::close(fd);
+    if (!mapping) {
+        std::cerr << "Error mapping " << name << std::endl;
+        length = 0;
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapping)
+        munmap(mapping, length);
+    mapping = nullptr;
+    length = 0;
+}
+
+bool MappedVolume::open(const char *name) {
+    close();
+    if (!file.open(name))
+        return false;
+
+    const VolumeHeader *header = (const VolumeHeader *) file.data();
+    if (file.size() < sizeof(VolumeHeader) ||
+        std::memcmp(header->magic, VOLUME_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != VOLUME_VERSION || header->type >= VOLUME_TYPE_COUNT ||
+        header->dims[0] < 0 || header->dims[1] < 0 || header->dims[2] < 0) {
+        std::cerr << "Invalid binary volume " << name << std::endl;
+        close();
+        return false;
+    }
+
+    for (int axis = 0; axis < 3; axis++) {
+        _grid.dims[axis] = header->dims[axis];
+        _grid.spacing[axis] = header->spacing[axis];
+        _grid.origin[axis] = header->origin[axis];
+    }
+    _type = (VolumeType) header->type;
+    _min_value = header->min_value;
+    _max_value = header->max_value;
+
+    if (file.size() < sizeof(VolumeHeader) + _grid.n_samples() * volumeTypeSize(_type)) {
+        std::cerr << "Binary volume " << name << " is truncated" << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedVolume::close() {
+    file.close();
+    _grid = Grid();
+}
+
+const void *MappedVolume::data() const {
+    return file.is_open() ? file.data() + sizeof(VolumeHeader) : nullptr;
+}
+
+bool writeVolume(const char *name, const Grid &grid, VolumeType type, const void *data,
+                 float min_value, float max_value) {
+    VolumeHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, VOLUME_MAGIC, sizeof(header.magic));
+    header.version = VOLUME_VERSION;
+    header.type = type;
+    for (int axis = 0; axis < 3; axis++) {
+        header.dims[axis] = grid.dims[axis];
+        header.spacing[axis] = grid.spacing[axis];
+        header.origin[axis] = grid.origin[axis];
+    }
+    header.min_value = min_value;
+    header.max_value = max_value;
+
+    std::ofstream file(name, std::ios::binary);
+    file.write((const char *) &header, sizeof(header));
+    file.write((const char *) data, grid.n_samples() * volumeTypeSize(type));
+    if (!file) {
+        std::cerr << "Error writing volume " << name << std::endl;
+        return false;
+    }
+    return true;
+}
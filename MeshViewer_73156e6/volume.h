@@ -0,0 +1,93 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#ifndef __MeshViewer_volume_h_
+#define __MeshViewer_volume_h_
+#include <cstddef>
+#include <cstdint>
+#include "grid.h"
+#include "scalar.h"
+
+// Binary volume file: a 64 byte header followed by the samples in the same order and layout
+// as they are kept in memory (native byte order), so they can be used in place once mapped.
+struct VolumeHeader {
+  char magic[8];            // VOLUME_MAGIC
+  uint32_t version;
+  uint32_t type;            // VolumeType of the samples
+  int32_t dims[3];
+  float spacing[3];
+  float origin[3];
+  float min_value, max_value;
+  uint32_t reserved;
+};
+
+#define VOLUME_MAGIC "MCVOLUME"
+#define VOLUME_VERSION 1
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+ public:
+  MappedFile() : mapping(nullptr), length(0) {}
+  ~MappedFile() {close();}
+
+  bool open(const char *name);
+  void close();
+  bool is_open() const {return mapping != nullptr;}
+  const char *data() const {return (const char *) mapping;}
+  size_t size() const {return length;}
+
+ private:
+  void *mapping;
+  size_t length;
+
+  MappedFile(const MappedFile &);
+  MappedFile &operator=(const MappedFile &);
+};
+
+// Binary volume file mapped in memory. The samples are read straight from the mapping, pages
+// being loaded by the OS as they are first accessed.
+class MappedVolume {
+ public:
+  MappedVolume() : _type(VOLUME_FLOAT32), _min_value(0.f), _max_value(0.f) {}
+
+  // whether the file starts with the header of a binary volume
+  static bool isBinary(const char *name);
+
+  bool open(const char *name);
+  void close();
+  bool is_open() const {return file.is_open();}
+
+  const void *data() const;
+  VolumeType type() const {return _type;}
+  const Grid &grid() const {return _grid;}
+  float min_value() const {return _min_value;}
+  float max_value() const {return _max_value;}
+
+ private:
+  MappedFile file;
+  Grid _grid;
+  VolumeType _type;
+  float _min_value, _max_value;
+};
+
+// writes the samples of a volume as a binary volume file
+bool writeVolume(const char *name, const Grid &grid, VolumeType type, const void *data,
+                 float min_value, float max_value);
+
+#endif // __MeshViewer_volume_h_
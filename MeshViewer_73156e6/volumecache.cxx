@@ -0,0 +1,207 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#include "volumecache.h"
+
+#include <sys/stat.h>
+#include <algorithm>
+#include <iostream>
+
+#include "textvolume.h"
+
+size_t LoadedVolume::memory() const {
+    size_t sample_bytes = mapped.is_open() ? grid.n_samples() * volumeTypeSize(type)
+                                           : samples.capacity() * sizeof(float);
+    return sample_bytes + bricks.memory() + span_space.memory() + (preview ? preview->memory() : 0);
+}
+
+std::shared_ptr<const LoadedVolume> VolumeCache::acquire(const char *name, int num_threads, bool preview) {
+    struct stat info;
+    if (stat(name, &info) != 0) {
+        std::cerr << "Error opening volume " << name << std::endl;
+        return nullptr;
+    }
+
+    std::shared_ptr<Entry> entry;
+    std::promise<std::shared_ptr<LoadedVolume> > loading;
+    bool loader = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if ((*it)->name != name)
+                continue;
+            if ((*it)->file_size == info.st_size && (*it)->file_time == info.st_mtime) {
+                entries.splice(entries.begin(), entries, it);
+                entry = entries.front();
+            } else {
+                // the file changed: current users keep the old volume until they release it
+                entries.erase(it);
+            }
+            break;
+        }
+        if (!entry) {
+            // placeholder for the volume, which this user loads once the cache is unlocked
+            entry = std::make_shared<Entry>();
+            entry->name = name;
+            entry->file_size = info.st_size;
+            entry->file_time = info.st_mtime;
+            entry->volume = loading.get_future().share();
+            entries.push_front(entry);
+            loader = true;
+        }
+    }
+
+    std::shared_ptr<LoadedVolume> volume;
+    if (loader) {
+        volume = load(name, num_threads);
+        if (volume) {
+            volume->file_size = info.st_size;
+            volume->file_time = info.st_mtime;
+        }
+        loading.set_value(volume);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (volume)
+            evict();
+        else
+            entries.remove(entry);
+    } else {
+        volume = entry->volume.get();
+    }
+    if (!volume)
+        return nullptr;
+    if (!preview)
+        return volume;
+
+    // the preview is owned by the volume, which stays pinned while it is used
+    std::call_once(volume->preview_built, [&]() {
+        std::unique_ptr<LoadedVolume> coarse = downsample(*volume, LoadedVolume::PREVIEW_FACTOR);
+        std::lock_guard<std::mutex> lock(mutex);
+        volume->preview = std::move(coarse);
+        evict();
+    });
+    return std::shared_ptr<const LoadedVolume>(volume, volume->preview.get());
+}
+
+std::shared_ptr<LoadedVolume> VolumeCache::load(const char *name, int num_threads) {
+    std::shared_ptr<LoadedVolume> volume = std::make_shared<LoadedVolume>();
+    volume->name = name;
+
+    if (MappedVolume::isBinary(name)) {
+        // binary volumes are used in place, and store their range in the header
+        if (!volume->mapped.open(name)) return nullptr;
+        volume->grid = volume->mapped.grid();
+        volume->data = volume->mapped.data();
+        volume->type = volume->mapped.type();
+        volume->min_value = volume->mapped.min_value();
+        volume->max_value = volume->mapped.max_value();
+    } else {
+        if (!readTextVolume(name, volume->grid, volume->samples, volume->min_value, volume->max_value, num_threads))
+            return nullptr;
+        volume->data = volume->samples.data();
+        volume->type = VOLUME_FLOAT32;
+    }
+
+    // value range of blocks of cells, to skip the ones far from the surface
+    volume->bricks.build(volume->data, volume->type, volume->grid);
+    volume->span_space.build(volume->bricks);
+    return volume;
+}
+
+std::unique_ptr<LoadedVolume> VolumeCache::downsample(const LoadedVolume &volume, int factor) {
+    std::unique_ptr<LoadedVolume> preview(new LoadedVolume);
+    preview->name = volume.name;
+    const Grid &grid = volume.grid;
+    Grid &coarse = preview->grid;
+    int step[3], radius[3];
+    for (int a = 0; a < 3; a++) {
+        step[a] = std::max(1, std::min(factor, grid.dims[a] - 1));
+        radius[a] = std::max(0, step[a] / 2 - 1);
+        coarse.dims[a] = (grid.dims[a] - 1) / step[a] + 1;
+        coarse.spacing[a] = grid.spacing[a] * step[a];
+        coarse.origin[a] = grid.origin[a];
+    }
+
+    // each sample is the average of those of the volume less than half a step away from it. The
+    // range is the one of the volume, so that isovalues are chosen the same way for both.
+    preview->samples.resize(coarse.n_samples());
+    for (int i = 0; i < coarse.dims[0]; i++) {
+        int i_0 = std::max(0, i*step[0] - radius[0]), i_1 = std::min(grid.dims[0] - 1, i*step[0] + radius[0]);
+        for (int j = 0; j < coarse.dims[1]; j++) {
+            int j_0 = std::max(0, j*step[1] - radius[1]), j_1 = std::min(grid.dims[1] - 1, j*step[1] + radius[1]);
+            for (int k = 0; k < coarse.dims[2]; k++) {
+                int k_0 = std::max(0, k*step[2] - radius[2]), k_1 = std::min(grid.dims[2] - 1, k*step[2] + radius[2]);
+                float sum = 0.f;
+                for (int fi = i_0; fi <= i_1; fi++)
+                    for (int fj = j_0; fj <= j_1; fj++)
+                        for (int fk = k_0; fk <= k_1; fk++)
+                            sum += sampleValue(volume.data, volume.type, grid.index(fi, fj, fk));
+                preview->samples[coarse.index(i, j, k)] = sum / ((i_1 - i_0 + 1) * (j_1 - j_0 + 1) * (k_1 - k_0 + 1));
+            }
+        }
+    }
+    preview->data = preview->samples.data();
+    preview->type = VOLUME_FLOAT32;
+    preview->min_value = volume.min_value;
+    preview->max_value = volume.max_value;
+    preview->file_size = volume.file_size;
+    preview->file_time = volume.file_time;
+
+    preview->bricks.build(preview->data, preview->type, coarse);
+    preview->span_space.build(preview->bricks);
+    return preview;
+}
+
+void VolumeCache::evict() {
+    // the volumes still being loaded take no memory yet, and are never released
+    size_t usage = 0;
+    for (const std::shared_ptr<Entry> &entry : entries)
+        usage += entry->get() ? entry->get()->memory() : 0;
+    for (auto it = entries.end(); it != entries.begin() && usage > limit;) {
+        --it;
+        if ((*it)->unpinned()) {
+            usage -= (*it)->get()->memory();
+            it = entries.erase(it);
+        }
+    }
+}
+
+void VolumeCache::setMemoryLimit(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    limit = bytes;
+    evict();
+}
+
+size_t VolumeCache::memoryUsage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t usage = 0;
+    for (const std::shared_ptr<Entry> &entry : entries)
+        usage += entry->get() ? entry->get()->memory() : 0;
+    return usage;
+}
+
+size_t VolumeCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+void VolumeCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = entries.begin(); it != entries.end();)
+        it = (*it)->unpinned() ? entries.erase(it) : ++it;
+}
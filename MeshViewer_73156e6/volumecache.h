@@ -0,0 +1,116 @@
+// ---------------------------------------------------------------------
+//     MeshViewer
+// Copyright (c) 2019, The ViRVIG resesarch group, U.P.C.
+// https://www.virvig.eu
+//
+// This file is part of MeshViewer
+// MeshViewer is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+#ifndef __MeshViewer_volumecache_h_
+#define __MeshViewer_volumecache_h_
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "grid.h"
+#include "scalar.h"
+#include "volume.h"
+#include "bricks.h"
+#include "spanspace.h"
+
+// A volume loaded from a file, along with the structures derived from it to speed up the
+// extraction. It does not change once loaded, so it can be shared by any number of users.
+struct LoadedVolume {
+  std::string name;
+  Grid grid;
+  VolumeType type;
+  const void *data;               // samples of the volume, of the given type, from one of:
+  std::vector<float> samples;     //   a parsed text volume
+  MappedVolume mapped;            //   a mapped binary volume
+  float min_value, max_value;
+  MinMaxBricks bricks;
+  SpanSpace span_space;
+  // the volume downsampled PREVIEW_FACTOR times along each axis, for quick previews of its
+  // isosurfaces. It is built by the cache the first time it is requested.
+  static const int PREVIEW_FACTOR = 4;
+  std::unique_ptr<LoadedVolume> preview;
+  std::once_flag preview_built;
+
+  // size and modification time of the file when it was loaded
+  long long file_size;
+  time_t file_time;
+
+  LoadedVolume() : type(VOLUME_FLOAT32), data(nullptr), min_value(0.f), max_value(0.f),
+                   file_size(0), file_time(0) {}
+  // bytes taken by the samples and the derived structures
+  size_t memory() const;
+};
+
+// Volumes recently loaded, kept by file name so that computing other isosurfaces of them does
+// not read the file again. Volumes are reference counted: the ones held by a user are pinned,
+// and the least recently used of the others are released when the cache takes more memory
+// than its limit. A volume whose file has changed since it was loaded is loaded again.
+// Volumes and previews are loaded outside the lock of the cache: other volumes can be acquired
+// meanwhile, and the users of the one being loaded wait for it.
+class VolumeCache {
+ public:
+  explicit VolumeCache(size_t memory_limit = DEFAULT_LIMIT) : limit(memory_limit) {}
+
+  static const size_t DEFAULT_LIMIT = size_t(2) << 30;
+
+  // the volume stored in the given file, loaded if it is not cached (null on error), or its
+  // preview. num_threads is used to parse text volumes (0 = one per hardware thread).
+  std::shared_ptr<const LoadedVolume> acquire(const char *name, int num_threads = 0, bool preview = false);
+
+  void setMemoryLimit(size_t bytes);
+  size_t memoryLimit() const {return limit;}
+  // bytes taken by the cached volumes, including the pinned ones
+  size_t memoryUsage() const;
+  size_t size() const;
+  // releases the volumes that are not pinned
+  void clear();
+
+ private:
+  // a file in the cache. Its volume is loaded by the first user that acquires it, and is null
+  // until then, or if it could not be loaded.
+  struct Entry {
+    std::string name;
+    long long file_size;
+    time_t file_time;
+    std::shared_future<std::shared_ptr<LoadedVolume> > volume;
+    bool loaded() const {return volume.wait_for(std::chrono::seconds(0)) == std::future_status::ready;}
+    const LoadedVolume *get() const {return loaded() ? volume.get().get() : nullptr;}
+    // whether the volume is only held by the cache
+    bool unpinned() const {return loaded() && volume.get().use_count() == 1;}
+  };
+
+  // most recently used first
+  std::list<std::shared_ptr<Entry> > entries;
+  size_t limit;
+  mutable std::mutex mutex;
+
+  static std::shared_ptr<LoadedVolume> load(const char *name, int num_threads);
+  static std::unique_ptr<LoadedVolume> downsample(const LoadedVolume &volume, int factor);
+  void evict();
+
+  VolumeCache(const VolumeCache &);
+  VolumeCache &operator=(const VolumeCache &);
+};
+
+#endif // __MeshViewer_volumecache_h_